@@ -0,0 +1,170 @@
+// Throughput of TapeBatch against one ProcessBlock per instance, and how far
+// the batched chain deviates from TapeDSP on the same material.
+//
+//   ToBIAS_BatchBench [stereoInstances=16]
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "DSP/TapeBatch.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 1000;
+    constexpr int lanes = 8;
+
+    // Per-instance settings so no two lanes share parameters
+    void configure(MarsDSP::ParameterValues& params, int instance, bool withFlutter)
+    {
+        const float spread = static_cast<float>(instance % 8) / 8.0f;
+        params.set(MarsDSP::Param::input, 0.4f + 0.3f * spread);
+        params.set(MarsDSP::Param::tilt, 0.3f + 0.5f * spread);
+        params.set(MarsDSP::Param::shape, 0.6f - 0.4f * spread);
+        params.set(MarsDSP::Param::bias, 0.2f + 0.6f * spread);
+        params.set(MarsDSP::Param::flutter, withFlutter ? 0.5f : 0.0f);
+        params.set(MarsDSP::Param::bumpHz, 60.0f + 10.0f * spread);
+    }
+
+    double sourceSample(int instance, int channel, int index)
+    {
+        const double t = index / sampleRate;
+        const double freq = 110.0 * (1 + instance % 5) + 17.0 * channel;
+        return (0.4 + 0.3 * std::sin(t * 2.3 + instance)) * std::sin(juce::MathConstants<double>::twoPi * freq * t);
+    }
+
+    double runScalar(int numInstances, bool withFlutter, std::vector<std::vector<float>>& output)
+    {
+        std::vector<std::unique_ptr<MarsDSP::ParameterValues>> params;
+        std::vector<std::unique_ptr<ProcessBlock<MarsDSP::ParameterValues>>> engines;
+
+        for (int n = 0; n < numInstances; ++n)
+        {
+            params.push_back(std::make_unique<MarsDSP::ParameterValues>());
+            configure(*params.back(), n, withFlutter);
+            engines.push_back(std::make_unique<ProcessBlock<MarsDSP::ParameterValues>>());
+            engines.back()->prepareDSP(sampleRate, blockSize, 2, *params.back());
+        }
+
+        output.assign(static_cast<size_t>(numInstances) * 2, std::vector<float>(static_cast<size_t>(blockSize * numBlocks)));
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int n = 0; n < numInstances; ++n)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, static_cast<float>(sourceSample(n, ch, block * blockSize + i)));
+
+                const auto start = Clock::now();
+                engines[static_cast<size_t>(n)]->process(buffer);
+                elapsedMs += millisecondsSince(start);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    std::copy_n(buffer.getReadPointer(ch), blockSize, output[static_cast<size_t>(n * 2 + ch)].begin() + block * blockSize);
+            }
+        }
+
+        return elapsedMs;
+    }
+
+    double runBatched(int numInstances, bool withFlutter, std::vector<std::vector<float>>& output)
+    {
+        const int numChannels = numInstances * 2;
+        const int numBatches = (numChannels + lanes - 1) / lanes;
+        std::vector<std::unique_ptr<TapeBatch<lanes>>> batches;
+
+        for (int b = 0; b < numBatches; ++b)
+        {
+            batches.push_back(std::make_unique<TapeBatch<lanes>>());
+            batches.back()->prepare(sampleRate);
+
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                MarsDSP::ParameterValues params;
+                configure(params, (b * lanes + lane) / 2, withFlutter);
+                batches.back()->setParameters(lane, params);
+            }
+        }
+
+        output.assign(static_cast<size_t>(numChannels), std::vector<float>(static_cast<size_t>(blockSize * numBlocks)));
+        std::vector<std::vector<float>> input(static_cast<size_t>(numChannels), std::vector<float>(static_cast<size_t>(blockSize)));
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < blockSize; ++i)
+                    input[static_cast<size_t>(c)][static_cast<size_t>(i)] = static_cast<float>(sourceSample(c / 2, c % 2, block * blockSize + i));
+
+            for (int b = 0; b < numBatches; ++b)
+            {
+                std::array<const float*, lanes> in {};
+                std::array<float*, lanes> out {};
+                const int active = std::min(lanes, numChannels - b * lanes);
+
+                for (int lane = 0; lane < active; ++lane)
+                {
+                    in[static_cast<size_t>(lane)] = input[static_cast<size_t>(b * lanes + lane)].data();
+                    out[static_cast<size_t>(lane)] = output[static_cast<size_t>(b * lanes + lane)].data() + block * blockSize;
+                }
+
+                const auto start = Clock::now();
+                batches[static_cast<size_t>(b)]->process(in.data(), out.data(), blockSize, active);
+                elapsedMs += millisecondsSince(start);
+            }
+        }
+
+        return elapsedMs;
+    }
+
+    void bench(int numInstances, bool withFlutter)
+    {
+        std::vector<std::vector<float>> reference, batched;
+        const double scalarMs = runScalar(numInstances, withFlutter, reference);
+        const double batchMs = runBatched(numInstances, withFlutter, batched);
+
+        const double channelSamples = static_cast<double>(numInstances) * 2.0 * blockSize * numBlocks;
+
+        std::printf("%d stereo instances, flutter %s\n", numInstances, withFlutter ? "on" : "off");
+        std::printf("  ProcessBlock each  %8.2f ns/channel-sample\n", scalarMs * 1.0e6 / channelSamples);
+        std::printf("  TapeBatch<%d>       %8.2f ns/channel-sample  (%.2fx)\n", lanes, batchMs * 1.0e6 / channelSamples, scalarMs / batchMs);
+
+        // Flutter randomness differs per engine, so only compare the deterministic chain
+        if (! withFlutter)
+        {
+            double errorPower = 0.0, signalPower = 0.0, maxAbs = 0.0;
+
+            for (size_t c = 0; c < reference.size(); ++c)
+            {
+                for (size_t i = 0; i < reference[c].size(); ++i)
+                {
+                    const double error = batched[c][i] - reference[c][i];
+                    maxAbs = std::max(maxAbs, std::abs(error));
+                    errorPower += error * error;
+                    signalPower += static_cast<double>(reference[c][i]) * reference[c][i];
+                }
+            }
+
+            std::printf("  deviation          max %.2e, SNR vs TapeDSP %.1f dB\n",
+                        maxAbs, 10.0 * std::log10(signalPower / std::max(errorPower, 1.0e-30)));
+        }
+
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int numInstances = argc > 1 ? std::max(1, std::atoi(argv[1])) : 16;
+
+    bench(numInstances, false);
+    bench(numInstances, true);
+    return 0;
+}
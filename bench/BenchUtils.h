@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#if defined(__APPLE__)
+ #include <mach/mach.h>
+#elif defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <psapi.h>
+#else
+ #include <unistd.h>
+ #if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+ #endif
+#endif
+
+namespace MarsDSP::Bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    inline double millisecondsSince(Clock::time_point start) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Current resident set size in bytes, 0 if unavailable
+    inline size_t getResidentSetSize() noexcept
+    {
+#if defined(__APPLE__)
+        mach_task_basic_info info {};
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+            return 0;
+        return static_cast<size_t>(info.resident_size);
+#elif defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters {};
+        if (! GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return static_cast<size_t>(counters.WorkingSetSize);
+#else
+        long pages = 0, resident = 0;
+        if (auto* file = std::fopen("/proc/self/statm", "r"))
+        {
+            if (std::fscanf(file, "%ld %ld", &pages, &resident) != 2)
+                resident = 0;
+            std::fclose(file);
+        }
+        return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    // Largest sample-to-sample step in x over [from, to), for spotting clicks
+    template <typename SampleType>
+    double largestStep(const std::vector<SampleType>& x, size_t from, size_t to)
+    {
+        double largest = 0.0;
+
+        for (size_t i = std::max<size_t>(from, 1); i < std::min(to, x.size()); ++i)
+            largest = std::max(largest, static_cast<double>(std::abs(x[i] - x[i - 1])));
+
+        return largest;
+    }
+
+    // Hardware cache-miss counter for the calling thread (Linux perf events).
+    // stop() returns -1 where counters are unavailable (other platforms,
+    // containers without perf access); run under a profiler there instead.
+    class CacheMissCounter
+    {
+    public:
+        enum class Level { l1Data, lastLevel };
+
+        explicit CacheMissCounter(Level level) noexcept
+        {
+#if defined(__linux__)
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            if (level == Level::l1Data)
+            {
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            }
+            else
+            {
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            }
+
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+            (void) level;
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#if defined(__linux__)
+            if (fd >= 0)
+                close(fd);
+#endif
+        }
+
+        void start() noexcept
+        {
+#if defined(__linux__)
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        long long stop() noexcept
+        {
+#if defined(__linux__)
+            if (fd < 0)
+                return -1;
+
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            long long count = 0;
+            if (::read(fd, &count, sizeof(count)) != sizeof(count))
+                return -1;
+
+            return count;
+#else
+            return -1;
+#endif
+        }
+
+    private:
+        int fd = -1;
+    };
+
+    inline double toMegabytes(size_t bytes) noexcept
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
@@ -0,0 +1,179 @@
+// CPU cost and deviation of the multi-rate compander against the per-sample
+// CompanderBand, first for the four compander bands alone (encode/decode x L/R)
+// and then for the whole TapeDSP chain.
+//
+//   ToBIAS_CompanderBench [decimation=8]
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 4000;
+
+    // Band-limited noise plus a swept tone with a slow amplitude envelope
+    std::vector<double> makeProgram(int numSamples, uint32_t seed)
+    {
+        NoiseGenerator rng;
+        rng.seed(seed);
+
+        std::vector<float> white(static_cast<size_t>(numSamples));
+        rng.fillUniform(white.data(), numSamples);
+
+        std::vector<double> signal(static_cast<size_t>(numSamples));
+        double lowpass = 0.0, phase = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            lowpass += 0.2 * ((white[static_cast<size_t>(i)] * 2.0 - 1.0) - lowpass);
+            phase += juce::MathConstants<double>::twoPi * (200.0 + 4000.0 * (0.5 + 0.5 * std::sin(t * 0.7))) / sampleRate;
+            const double envelope = 0.5 + 0.45 * std::sin(t * 3.1);
+            signal[static_cast<size_t>(i)] = envelope * (0.5 * std::sin(phase) + 0.3 * lowpass);
+        }
+
+        return signal;
+    }
+
+    struct Deviation
+    {
+        double maxAbs = 0.0;
+        double errorPower = 0.0;
+        double signalPower = 0.0;
+
+        void add(double reference, double value) noexcept
+        {
+            const double error = value - reference;
+            maxAbs = std::max(maxAbs, std::abs(error));
+            errorPower += error * error;
+            signalPower += reference * reference;
+        }
+
+        double snrDb() const noexcept
+        {
+            return 10.0 * std::log10(std::max(signalPower, 1.0e-30) / std::max(errorPower, 1.0e-30));
+        }
+    };
+
+    void benchBands(int decimation)
+    {
+        const int numSamples = blockSize * numBlocks;
+        const auto left = makeProgram(numSamples, 0x1234567u);
+        const auto right = makeProgram(numSamples, 0x7654321u);
+
+        const double encodeAmount = 1.4, decodeAmount = -0.6;
+        const double encodeFreq = 0.5 / (sampleRate / 44100.0);
+        const double decodeFreq = 0.5 / (sampleRate / 44100.0);
+
+        // Reference: four per-sample CompanderBands
+        std::vector<double> refL(left), refR(right);
+        CompanderBand encodeL, encodeR, decodeL, decodeR;
+
+        auto start = Clock::now();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            encodeL.process(refL[static_cast<size_t>(i)], encodeAmount, encodeFreq, false);
+            encodeR.process(refR[static_cast<size_t>(i)], encodeAmount, encodeFreq, false);
+            decodeL.process(refL[static_cast<size_t>(i)], decodeAmount, decodeFreq, true);
+            decodeR.process(refR[static_cast<size_t>(i)], decodeAmount, decodeFreq, true);
+        }
+
+        const double perSampleNs = millisecondsSince(start) * 1.0e6 / numSamples;
+
+        // Multi-rate, block-wise
+        std::vector<double> outL(left), outR(right);
+        MultiRateCompander encode(false), decode(true);
+        encode.reset();
+        decode.reset();
+        encode.setDecimation(decimation);
+        decode.setDecimation(decimation);
+
+        start = Clock::now();
+
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            encode.process(outL.data() + offset, outR.data() + offset, blockSize, encodeAmount, encodeFreq);
+            decode.process(outL.data() + offset, outR.data() + offset, blockSize, decodeAmount, decodeFreq);
+        }
+
+        const double multiRateNs = millisecondsSince(start) * 1.0e6 / numSamples;
+
+        Deviation deviation;
+        for (size_t i = 0; i < outL.size(); ++i)
+        {
+            deviation.add(refL[i], outL[i]);
+            deviation.add(refR[i], outR[i]);
+        }
+
+        std::printf("compander bands (4), decimation %d\n", decimation);
+        std::printf("  per-sample   %8.2f ns/frame\n", perSampleNs);
+        std::printf("  multi-rate   %8.2f ns/frame  (%.1f%% saved)\n", multiRateNs, 100.0 * (1.0 - multiRateNs / perSampleNs));
+        std::printf("  deviation    max %.2e, SNR vs reference %.1f dB\n\n", deviation.maxAbs, deviation.snrDb());
+    }
+
+    double runEngine(CompanderMode mode, int decimation, std::vector<float>& output)
+    {
+        MarsDSP::ParameterValues params;
+        params.set(MarsDSP::Param::flutter, 0.0f);
+        params.set(MarsDSP::Param::tilt, 0.7f);
+        params.set(MarsDSP::Param::compander, static_cast<int>(mode));
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.setCompanderDecimation(decimation);
+        processor.prepareDSP(sampleRate, blockSize, 2, params);
+
+        const auto program = makeProgram(blockSize * numBlocks, 0xABCDEFu);
+        output.assign(program.size(), 0.0f);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(ch, i, static_cast<float>(program[static_cast<size_t>(block * blockSize + i)]));
+
+            const auto start = Clock::now();
+            processor.process(buffer);
+            elapsedMs += millisecondsSince(start);
+
+            for (int i = 0; i < blockSize; ++i)
+                output[static_cast<size_t>(block * blockSize + i)] = buffer.getSample(0, i);
+        }
+
+        return elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+    }
+
+    void benchEngine(int decimation)
+    {
+        std::vector<float> reference, multiRate;
+        const double perSampleNs = runEngine(CompanderMode::perSample, decimation, reference);
+        const double multiRateNs = runEngine(CompanderMode::multiRate, decimation, multiRate);
+
+        Deviation deviation;
+        for (size_t i = 0; i < reference.size(); ++i)
+            deviation.add(reference[i], multiRate[i]);
+
+        std::printf("TapeDSP chain, stereo, flutter off\n");
+        std::printf("  per-sample   %8.2f ns/frame\n", perSampleNs);
+        std::printf("  multi-rate   %8.2f ns/frame  (%.1f%% saved)\n", multiRateNs, 100.0 * (1.0 - multiRateNs / perSampleNs));
+        std::printf("  deviation    max %.2e, SNR vs reference %.1f dB\n", deviation.maxAbs, deviation.snrDb());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int decimation = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+
+    benchBands(decimation);
+    benchEngine(decimation);
+    return 0;
+}
@@ -0,0 +1,297 @@
+// NaN/Inf containment: what the per-block checks in ProcessBlock cost, and
+// what an adversarial block does to the output and to the blocks after it.
+//
+// The check cost is SignalGuard::isSafe over a host block, per sample, next to
+// a full ProcessBlock pass. For each kind of bad input, one bad block is fed
+// between clean ones; the output must stay finite and bounded throughout and
+// come back to the level of a clean run. Input just below SignalGuard::limit
+// (railed, square, DC, impulses) is not caught and runs for 20 blocks, which
+// the engine has to ride out on its own. The same goes for NaN left in each
+// part of the engine's state under clean input, which the output check has
+// to catch, repairing only what the NaN reached. The bench exits with 1 if
+// any run fails.
+//
+//   ToBIAS_ContainmentBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+#include <bit>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int hostBlock = 512;
+    constexpr int numBlocks = 200;
+
+    void configure(MarsDSP::ParameterValues& params)
+    {
+        params.set(MarsDSP::Param::input, 0.9f);
+        params.set(MarsDSP::Param::bumpHead, 0.9f);
+        params.set(MarsDSP::Param::hysteresis, 2);
+    }
+
+    void fillClean(juce::AudioBuffer<float>& buffer, int block)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < hostBlock; ++i)
+                buffer.setSample(ch, i, 0.5f * std::sin(static_cast<float>((block * hostBlock) + i) * 0.05f));
+    }
+
+    void benchCheckCost()
+    {
+        std::vector<float> block(static_cast<size_t>(hostBlock), 0.25f);
+        constexpr int repeats = 200000;
+        int safe = 0;
+
+        const auto start = Clock::now();
+
+        for (int r = 0; r < repeats; ++r)
+        {
+            block[static_cast<size_t>(r % hostBlock)] = static_cast<float>(r & 1) * 0.5f;
+            safe += SignalGuard::isSafe(block.data(), hostBlock) ? 1 : 0;
+        }
+
+        const double checkNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(repeats) * hostBlock);
+
+        MarsDSP::ParameterValues params;
+        configure(params);
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+
+        const auto processStart = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            fillClean(buffer, b);
+            processor.process(buffer);
+        }
+
+        const double processNs = millisecondsSince(processStart) * 1.0e6 / (static_cast<double>(numBlocks) * hostBlock);
+
+        // Input and output of both channels are checked
+        std::printf("Check     %.3f ns/sample (%d safe)\nProcess   %.1f ns/frame\nShare     %.2f%% of a stereo pass\n\n",
+                    checkNs, safe, processNs, 100.0 * 4.0 * checkNs / processNs);
+    }
+
+    enum class Poison { nan, inf, huge, randomBits, railed, railedBelow, square, dc, impulses };
+
+    void poison(juce::AudioBuffer<float>& buffer, Poison kind, std::mt19937& rng)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            for (int i = 0; i < hostBlock; ++i)
+            {
+                float& x = buffer.getWritePointer(ch)[i];
+
+                switch (kind)
+                {
+                    case Poison::nan:         if (rng() % 64 == 0) x = std::numeric_limits<float>::quiet_NaN(); break;
+                    case Poison::inf:         if (rng() % 64 == 0) x = std::numeric_limits<float>::infinity(); break;
+                    case Poison::huge:        x *= 1.0e30f; break;
+                    case Poison::randomBits:  { const auto bits = static_cast<std::uint32_t>(rng()); std::memcpy(&x, &bits, sizeof(x)); break; }
+                    case Poison::railed:      x = (i & 1) != 0 ? 1.0e6f : -1.0e6f; break;
+                    case Poison::railedBelow: x = (i & 1) != 0 ? 60.0f : -60.0f; break;
+                    case Poison::square:      x = (i & 32) != 0 ? 1.0f : -1.0f; break;
+                    case Poison::dc:          x = 63.0f; break;
+                    case Poison::impulses:    x = i % 100 == 0 ? 63.0f : 0.0f; break;
+                }
+            }
+        }
+    }
+
+    struct Result
+    {
+        bool bounded = true;
+        int inputFaults = 0, outputFaults = 0;
+        uint32_t recovered = 0;
+        double tailPeak = 0.0;      // over the last 50 blocks, which every run should agree on
+        double fadeStart = 0.0;     // first output sample of the block after the bad ones
+    };
+
+    constexpr int badBlock = numBlocks / 4;
+
+    // Runs the clean program on the settings of configure plus setup, with
+    // spoil(buffer, processor) called just before each of numBad blocks from
+    // badBlock on is processed
+    template <typename Setup, typename Spoil>
+    Result run(Setup&& setup, Spoil&& spoil, int numBad = 1)
+    {
+        MarsDSP::ParameterValues params;
+        configure(params);
+        setup(params);
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        Result result;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            fillClean(buffer, b);
+
+            const bool bad = b >= badBlock && b < badBlock + numBad;
+
+            if (bad)
+                spoil(buffer, processor);
+
+            processor.process(buffer);
+
+            if (bad)
+                result.recovered |= processor.getRecoveredState();
+
+            if (b == badBlock + numBad)
+                result.fadeStart = std::abs(buffer.getSample(0, 0));
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                result.bounded = result.bounded && SignalGuard::isSafe(buffer.getReadPointer(ch), hostBlock);
+
+                if (b >= numBlocks - 50)
+                    result.tailPeak = std::max(result.tailPeak, static_cast<double>(buffer.getMagnitude(ch, 0, hostBlock)));
+            }
+        }
+
+        result.inputFaults = processor.getNumInputFaults();
+        result.outputFaults = processor.getNumFaults();
+        return result;
+    }
+
+    void defaults(MarsDSP::ParameterValues&) {}
+
+    template <typename Setup>
+    double cleanPeak(Setup&& setup)
+    {
+        return run(setup, [](juce::AudioBuffer<float>&, auto&) {}).tailPeak;
+    }
+
+    bool recovers(const Result& result, double clean)
+    {
+        return result.bounded && std::abs((result.tailPeak / clean) - 1.0) < 0.01;
+    }
+
+    // Bad input: silenced on the way in, one input fault and no output fault.
+    // Input just below SignalGuard::limit is let through, for 20 blocks: the
+    // engine has to take it without a fault of either kind.
+    bool benchInput()
+    {
+        std::printf("Input         in faults   out faults   bounded   tail peak / clean\n");
+
+        struct Case { Poison kind; const char* name; bool passes; };
+        const Case cases[] { { Poison::nan, "NaN", false }, { Poison::inf, "Inf", false }, { Poison::huge, "1e30", false },
+                             { Poison::randomBits, "random bits", false }, { Poison::railed, "+-1e6", false },
+                             { Poison::railedBelow, "+-60", true }, { Poison::square, "square 0 dB", true },
+                             { Poison::dc, "DC 63", true }, { Poison::impulses, "impulses 63", true } };
+
+        const double clean = cleanPeak(defaults);
+        bool passed = true;
+
+        for (const auto& c : cases)
+        {
+            std::mt19937 rng(7);
+            const auto result = run(defaults, [&](juce::AudioBuffer<float>& buffer, auto&) { poison(buffer, c.kind, rng); }, c.passes ? 20 : 1);
+            const bool ok = recovers(result, clean) && result.inputFaults == (c.passes ? 0 : 1) && result.outputFaults == 0;
+
+            std::printf("%-12s  %9d   %10d   %7s   %17.3f   %s\n", c.name, result.inputFaults, result.outputFaults,
+                        result.bounded ? "yes" : "NO", result.tailPeak / clean, ok ? "ok" : "FAILED");
+            passed = passed && ok;
+        }
+
+        return passed;
+    }
+
+    // How a part of the state deals with NaN left in it
+    enum class Expect
+    {
+        reset,      // the output is caught and the part is reset, with whatever the NaN reached downstream
+        flushed,    // as reset, but the part's memory is a few samples long and clean again by the end of the block
+        healed      // the part gets over it alone and the output never sees it
+    };
+
+    // Internal state gone non-finite under clean input, which SignalGuard lets
+    // through. Where the output is caught, every part upstream of the poisoned
+    // one must be kept and the next block faded in from silence. Each part
+    // runs on settings that put it in the signal path.
+    bool benchState()
+    {
+        constexpr std::array<const char*, 14> partNames { "encode", "mr-encode", "delay", "hysteresis", "j-a", "crossover", "lows",
+                                                          "highs", "bump", "hiss", "decode", "mr-decode", "clipper", "clip-adaa" };
+
+        using Setup = void (*)(MarsDSP::ParameterValues&);
+        const Setup multiRate = [](MarsDSP::ParameterValues& p) { p.set(MarsDSP::Param::compander, 1); };
+        const Setup stages = [](MarsDSP::ParameterValues& p) { p.set(MarsDSP::Param::hysteresis, 0); p.set(MarsDSP::Param::bias, 0.8f); };
+        const Setup antialiased = [](MarsDSP::ParameterValues& p) { p.set(MarsDSP::Param::antialias, 2); };
+        const Setup hiss = [](MarsDSP::ParameterValues& p) { p.set(MarsDSP::Param::hiss, 0.5f); };
+
+        struct Case { TapeDSP::StatePart part; Setup setup; Expect expect; };
+        const Case cases[] { { TapeDSP::encodeState, defaults, Expect::reset },
+                             { TapeDSP::multiRateEncodeState, multiRate, Expect::reset },
+                             { TapeDSP::flutterDelayState, defaults, Expect::reset },
+                             { TapeDSP::hysteresisState, stages, Expect::healed },
+                             { TapeDSP::jilesAthertonState, defaults, Expect::healed },
+                             { TapeDSP::crossoverState, defaults, Expect::reset },
+                             { TapeDSP::lowsShaperState, antialiased, Expect::flushed },
+                             { TapeDSP::highsShaperState, antialiased, Expect::flushed },
+                             { TapeDSP::headBumpState, defaults, Expect::reset },
+                             { TapeDSP::hissState, hiss, Expect::reset },
+                             { TapeDSP::decodeState, defaults, Expect::reset },
+                             { TapeDSP::multiRateDecodeState, multiRate, Expect::reset },
+                             { TapeDSP::clipperState, defaults, Expect::flushed },
+                             { TapeDSP::clipShaperState, antialiased, Expect::flushed } };
+
+        std::printf("\nState         out faults   bounded   tail peak / clean   fade from   reset\n");
+
+        bool passed = true;
+
+        for (const auto& c : cases)
+        {
+            const auto part = c.part;
+            const auto result = run(c.setup, [part](juce::AudioBuffer<float>&, auto& processor) { processor.poisonState(part); });
+            bool ok = recovers(result, cleanPeak(c.setup)) && result.inputFaults == 0;
+
+            if (c.expect == Expect::healed)
+            {
+                ok = ok && result.outputFaults == 0 && result.recovered == 0;
+            }
+            else
+            {
+                // StatePart bits are in signal order, so upstream is every lower bit
+                const bool upstreamKept = (result.recovered & (part - 1u)) == 0;
+                const bool partReset = (result.recovered & part) != 0;
+                ok = ok && result.outputFaults == 1 && partReset == (c.expect == Expect::reset) && upstreamKept && result.fadeStart == 0.0;
+            }
+
+            std::string reset;
+            for (size_t bit = 0; bit < partNames.size(); ++bit)
+                if ((result.recovered & (1u << bit)) != 0)
+                    reset += std::string(reset.empty() ? "" : " ") + partNames[bit];
+
+            const auto name = partNames[static_cast<size_t>(std::countr_zero(static_cast<uint32_t>(part)))];
+
+            std::printf("%-12s  %10d   %7s   %17.3f   %9.1e   %s   %s\n", name, result.outputFaults, result.bounded ? "yes" : "NO",
+                        result.tailPeak / cleanPeak(c.setup), result.fadeStart, reset.empty() ? "-" : reset.c_str(), ok ? "ok" : "FAILED");
+            passed = passed && ok;
+        }
+
+        return passed;
+    }
+}
+
+int main()
+{
+    benchCheckCost();
+
+    const auto clean = run(defaults, [](juce::AudioBuffer<float>&, auto&) {});
+
+    const bool inputPassed = benchInput();
+    const bool statePassed = benchState();
+    return inputPassed && statePassed && clean.bounded ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Tape generations fused into one ProcessBlock (the "generations" parameter)
+// against the same number of ProcessBlock instances chained the way a host
+// would run them: each instance over the whole host buffer before the next.
+// Also reports how far the two outputs drift apart. Flutter is off because its
+// random walk is seeded per engine; what is left is the denormal dither.
+//
+//   ToBIAS_GenerationsBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    using Engine = ProcessBlock<MarsDSP::ParameterValues>;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 1500;
+
+    // Unity input and output gain so the signal survives eight passes
+    void configure(MarsDSP::ParameterValues& params, int generations)
+    {
+        params.set(MarsDSP::Param::flutter, 0.0f);
+        params.set(MarsDSP::Param::input, 1.0f);
+        params.set(MarsDSP::Param::output, 1.0f);
+        params.set(MarsDSP::Param::generations, generations);
+    }
+
+    void fillInput(juce::AudioBuffer<float>& buffer, int block)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample(ch, i, 0.3f * static_cast<float>(std::sin((block * blockSize + i) * 0.013 + ch)));
+    }
+
+    struct Result
+    {
+        double nsPerFrame = 0.0;
+        std::vector<float> output;
+    };
+
+    Result runFused(int generations)
+    {
+        MarsDSP::ParameterValues params;
+        configure(params, generations);
+
+        Engine engine;
+        engine.prepareDSP(sampleRate, blockSize, 2, params);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        Result result;
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillInput(buffer, block);
+
+            const auto start = Clock::now();
+            engine.process(buffer);
+            elapsedMs += millisecondsSince(start);
+
+            result.output.insert(result.output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize);
+        }
+
+        result.nsPerFrame = elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+        return result;
+    }
+
+    Result runChained(int generations)
+    {
+        std::vector<std::unique_ptr<MarsDSP::ParameterValues>> params;
+        std::vector<std::unique_ptr<Engine>> engines;
+
+        for (int g = 0; g < generations; ++g)
+        {
+            params.push_back(std::make_unique<MarsDSP::ParameterValues>());
+            configure(*params.back(), 1);
+
+            engines.push_back(std::make_unique<Engine>());
+            engines.back()->prepareDSP(sampleRate, blockSize, 2, *params.back());
+        }
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        Result result;
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillInput(buffer, block);
+
+            const auto start = Clock::now();
+            for (auto& engine : engines)
+                engine->process(buffer);
+            elapsedMs += millisecondsSince(start);
+
+            result.output.insert(result.output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize);
+        }
+
+        result.nsPerFrame = elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+        return result;
+    }
+
+    double deviationDb(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        double error = 0.0, signal = 0.0;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            error += (a[i] - b[i]) * (a[i] - b[i]);
+            signal += a[i] * a[i];
+        }
+
+        return error > 0.0 ? 10.0 * std::log10(error / signal) : -999.0;
+    }
+}
+
+int main()
+{
+    std::printf("Stereo, %d-sample host blocks, flutter off\n", blockSize);
+    // Untimed pass so the first measurement does not pay for clock ramp-up
+    runChained(1);
+
+    std::printf("  generations   fused ns/frame   chained ns/frame   speedup   deviation\n");
+
+    for (int generations : { 1, 2, 4, 8 })
+    {
+        const auto fused = runFused(generations);
+        const auto chained = runChained(generations);
+
+        std::printf("  %11d   %14.2f   %16.2f   %6.2fx   %6.1f dB\n", generations, fused.nsPerFrame, chained.nsPerFrame,
+                    chained.nsPerFrame / fused.nsPerFrame, deviationDb(chained.output, fused.output));
+    }
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+// Tape hiss and the block-wise NoiseGenerator: what the generator costs per
+// value against the serial XORShift it replaced, what the hiss stage adds to a
+// ProcessBlock frame, and what the hiss looks like at the output.
+//
+// The spectrum is averaged over Hann-windowed 4096-point frames and read in
+// three bands. The tone is at bin 8 (93.75 Hz at 48 kHz), so its harmonics sit
+// on multiples of 8 and the noise is read half way between them. With the tone
+// playing, the noise has to rise (modulation noise); without hiss, the same
+// bins show the floor of the rest of the chain.
+//
+//   ToBIAS_HissBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+#include <cstdlib>
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int hostBlock = 256;
+
+    // The generator TapeDSP used before, one dependent step per value
+    struct XorShift
+    {
+        uint32_t state = 0xDEADBEEF;
+
+        double nextDouble() noexcept
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return static_cast<double>(state) / static_cast<double>(UINT32_MAX);
+        }
+    };
+
+    void benchGenerator()
+    {
+        constexpr int blockSize = 64, numBlocks = 400000;
+        alignas(64) std::array<float, blockSize> values {};
+        double sink = 0.0;
+
+        XorShift serial;
+        auto start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                values[static_cast<size_t>(i)] = static_cast<float>(serial.nextDouble());
+
+            sink += values[static_cast<size_t>(b % blockSize)];
+        }
+
+        const double serialNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+
+        NoiseGenerator noise;
+        start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            noise.fillUniform(values.data(), blockSize);
+            sink += values[static_cast<size_t>(b % blockSize)];
+        }
+
+        const double uniformNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+        start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            noise.fillNoise(values.data(), blockSize);
+            sink += values[static_cast<size_t>(b % blockSize)];
+        }
+
+        const double noiseNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+
+        // Moments of the hiss source, which should be 0 and 1
+        double sum = 0.0, squares = 0.0;
+        for (int b = 0; b < 10000; ++b)
+        {
+            noise.fillNoise(values.data(), blockSize);
+            for (const float v : values)
+            {
+                sum += v;
+                squares += static_cast<double>(v) * v;
+            }
+        }
+
+        const double count = 10000.0 * blockSize;
+
+        std::printf("Random values, ns/value   XORShift %5.2f   fillUniform %5.2f (%.1fx)   fillNoise %5.2f   (sink %.0f)\n",
+                    serialNs, uniformNs, serialNs / uniformNs, noiseNs, sink);
+        std::printf("fillNoise mean %+.4f   variance %.4f\n\n", sum / count, (squares / count) - ((sum / count) * (sum / count)));
+    }
+
+    void configure(MarsDSP::ParameterValues& params, float hiss)
+    {
+        params.set(MarsDSP::Param::flutter, 0.0f);
+        params.set(MarsDSP::Param::hiss, hiss);
+    }
+
+    double nsPerFrame(float hiss)
+    {
+        constexpr int numBlocks = 4000;
+
+        std::srand(1);
+
+        MarsDSP::ParameterValues params;
+        configure(params, hiss);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < hostBlock; ++i)
+                    buffer.setSample(ch, i, 0.4f * std::sin(static_cast<float>((block * hostBlock) + i) * 0.013f));
+
+            const auto start = Clock::now();
+            processor.process(buffer);
+            elapsedMs += millisecondsSince(start);
+        }
+
+        return elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * hostBlock);
+    }
+
+    void benchCost()
+    {
+        const double off = nsPerFrame(0.0f);
+        const double on = nsPerFrame(0.5f);
+
+        std::printf("ProcessBlock ns/frame   hiss off %6.1f   hiss on %6.1f   (+%.1f)\n\n", off, on, on - off);
+    }
+
+    struct Bands
+    {
+        double low = 0.0, mid = 0.0, high = 0.0;
+    };
+
+    // Mean power per bin, in dB, between the tone's harmonics in three bands
+    Bands measure(float hiss, float toneLevel)
+    {
+        constexpr int frameSize = 4096, numFrames = 24, skipFrames = 4;
+        constexpr int toneBin = 8;
+
+        std::srand(1);
+
+        MarsDSP::ParameterValues params;
+        configure(params, hiss);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+
+        std::vector<float> output;
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        const double step = juce::MathConstants<double>::twoPi * toneBin / frameSize;
+
+        for (int block = 0; block < ((numFrames + skipFrames) * frameSize) / hostBlock; ++block)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < hostBlock; ++i)
+                    buffer.setSample(ch, i, toneLevel * static_cast<float>(std::sin(step * ((block * hostBlock) + i))));
+
+            processor.process(buffer);
+            output.insert(output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + hostBlock);
+        }
+
+        // Bins 4 mod 8, in 200-600 Hz, 2-4 kHz and 8-16 kHz
+        const auto binOf = [](double hz) { return static_cast<int>(hz * frameSize / sampleRate); };
+        const std::array<std::pair<int, int>, 3> ranges { { { binOf(200.0), binOf(600.0) },
+                                                            { binOf(2000.0), binOf(4000.0) },
+                                                            { binOf(8000.0), binOf(16000.0) } } };
+        std::array<double, 3> power {};
+        std::array<int, 3> numBins {};
+
+        std::vector<double> frame(frameSize);
+
+        for (int f = skipFrames; f < numFrames + skipFrames; ++f)
+        {
+            for (int i = 0; i < frameSize; ++i)
+            {
+                const double window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / frameSize);
+                frame[static_cast<size_t>(i)] = window * output[static_cast<size_t>((f * frameSize) + i)];
+            }
+
+            for (size_t r = 0; r < ranges.size(); ++r)
+            {
+                for (int bin = ranges[r].first; bin < ranges[r].second; ++bin)
+                {
+                    if (bin % toneBin != toneBin / 2)
+                        continue;
+
+                    double re = 0.0, im = 0.0;
+                    const double w = juce::MathConstants<double>::twoPi * bin / frameSize;
+
+                    for (int i = 0; i < frameSize; ++i)
+                    {
+                        re += frame[static_cast<size_t>(i)] * std::cos(w * i);
+                        im -= frame[static_cast<size_t>(i)] * std::sin(w * i);
+                    }
+
+                    power[r] += (re * re) + (im * im);
+                    ++numBins[r];
+                }
+            }
+        }
+
+        const auto dB = [&](size_t r) { return 10.0 * std::log10(std::max(power[r] / numBins[r], 1.0e-30)); };
+        return { dB(0), dB(1), dB(2) };
+    }
+
+    void benchSpectrum()
+    {
+        std::printf("Noise power per bin, dB       200-600 Hz   2-4 kHz   8-16 kHz\n");
+
+        for (const float hiss : { 0.0f, 0.25f, 0.5f, 1.0f })
+        {
+            for (const float tone : { 0.0f, 0.5f })
+            {
+                const auto bands = measure(hiss, tone);
+                std::printf("hiss %.2f  %-10s       %10.1f   %7.1f   %8.1f\n", hiss, tone > 0.0f ? "tone -6 dB" : "silence",
+                            bands.low, bands.mid, bands.high);
+            }
+        }
+    }
+}
+
+int main()
+{
+    benchGenerator();
+    benchCost();
+    benchSpectrum();
+    return 0;
+}
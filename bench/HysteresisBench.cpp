@@ -0,0 +1,185 @@
+// Jiles-Atherton hysteresis against the slew limiter cascade.
+//
+// Each solver is timed on its own over a stereo program and compared with a
+// reference solution: RK4 integrated at 16x the sample rate on the linearly
+// interpolated input, read back at the original rate. The engine section
+// times the whole TapeDSP chain in every hysteresis mode.
+//
+//   ToBIAS_HysteresisBench [bias=0.3] [newtonIterations=4]
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 2000;
+    constexpr int referenceOversampling = 16;
+
+    // Low tone with a slow swell plus a quieter high partial
+    std::vector<double> makeProgram(int numSamples, double phaseOffset)
+    {
+        std::vector<double> signal(static_cast<size_t>(numSamples));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            const double swell = 0.3 + 0.6 * (0.5 + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 0.5 * t));
+            signal[static_cast<size_t>(i)] = swell * std::sin(juce::MathConstants<double>::twoPi * 110.0 * t + phaseOffset)
+                                           + 0.1 * std::sin(juce::MathConstants<double>::twoPi * 3100.0 * t);
+        }
+
+        return signal;
+    }
+
+    std::vector<double> runReference(const std::vector<double>& input, double bias)
+    {
+        JilesAthertonHysteresis hysteresis;
+        hysteresis.setSolver(HysteresisSolver::rk4);
+        hysteresis.updateConstants(bias, sampleRate * referenceOversampling);
+
+        std::vector<double> output(input.size());
+        std::array<double, referenceOversampling> upL {}, upR {};
+        double previous = 0.0;
+
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            for (int j = 0; j < referenceOversampling; ++j)
+            {
+                const double frac = static_cast<double>(j + 1) / referenceOversampling;
+                upL[static_cast<size_t>(j)] = previous + frac * (input[i] - previous);
+                upR[static_cast<size_t>(j)] = upL[static_cast<size_t>(j)];
+            }
+
+            hysteresis.process(upL.data(), upR.data(), referenceOversampling);
+            output[i] = upL.back();
+            previous = input[i];
+        }
+
+        return output;
+    }
+
+    struct Result
+    {
+        double nsPerFrame;
+        double errorDb;
+    };
+
+    template <typename Process>
+    Result runKernel(const std::vector<double>& left, const std::vector<double>& right,
+                     const std::vector<double>& reference, Process&& process)
+    {
+        std::vector<double> outL(left), outR(right);
+        const auto start = Clock::now();
+
+        for (size_t offset = 0; offset < outL.size(); offset += blockSize)
+            process(outL.data() + offset, outR.data() + offset, blockSize);
+
+        const double ns = millisecondsSince(start) * 1.0e6 / static_cast<double>(outL.size());
+
+        double error = 0.0, power = 0.0;
+        for (size_t i = 0; i < outL.size(); ++i)
+        {
+            error += (outL[i] - reference[i]) * (outL[i] - reference[i]);
+            power += reference[i] * reference[i];
+        }
+
+        return { ns, 10.0 * std::log10(std::max(error, 1.0e-30) / std::max(power, 1.0e-30)) };
+    }
+
+    void benchKernels(double bias, int newtonIterations)
+    {
+        const int numSamples = blockSize * numBlocks;
+        const auto left = makeProgram(numSamples, 0.0);
+        const auto right = makeProgram(numSamples, 0.3);
+        const auto reference = runReference(left, bias);
+
+        std::printf("hysteresis kernels, bias %.2f, stereo, error vs %dx RK4 reference (left)\n", bias, referenceOversampling);
+
+        HysteresisProcessor stages;
+        stages.updateThresholds(bias, sampleRate);
+
+        const auto cascade = runKernel(left, right, reference, [&](double* L, double* R, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                stages.process(L[i], R[i], bias, sampleRate);
+        });
+
+        std::printf("  stage cascade   %8.2f ns/frame\n", cascade.nsPerFrame);
+
+        const std::array<std::pair<const char*, HysteresisSolver>, 3> solvers
+        {{
+            { "J-A RK2        ", HysteresisSolver::rk2 },
+            { "J-A RK4        ", HysteresisSolver::rk4 },
+            { "J-A Newton     ", HysteresisSolver::newtonRaphson },
+        }};
+
+        for (const auto& [name, solver] : solvers)
+        {
+            JilesAthertonHysteresis hysteresis;
+            hysteresis.setSolver(solver);
+            hysteresis.setNewtonIterations(newtonIterations);
+
+            const auto result = runKernel(left, right, reference, [&](double* L, double* R, int n)
+            {
+                hysteresis.updateConstants(bias, sampleRate);
+                hysteresis.process(L, R, n);
+            });
+
+            std::printf("  %s %8.2f ns/frame  (%.1fx cascade), error %.1f dB\n",
+                        name, result.nsPerFrame, result.nsPerFrame / cascade.nsPerFrame, result.errorDb);
+        }
+
+        std::printf("\n");
+    }
+
+    void benchEngine(double bias)
+    {
+        const auto program = makeProgram(blockSize * numBlocks, 0.0);
+        const std::array<const char*, 4> names { "stage cascade", "J-A RK2", "J-A RK4", "J-A Newton" };
+
+        std::printf("TapeDSP chain, stereo, bias %.2f\n", bias);
+
+        for (int mode = 0; mode < static_cast<int>(names.size()); ++mode)
+        {
+            MarsDSP::ParameterValues params;
+            params.set(MarsDSP::Param::bias, static_cast<float>(bias));
+            params.set(MarsDSP::Param::hysteresis, mode);
+
+            ProcessBlock<MarsDSP::ParameterValues> processor;
+            processor.prepareDSP(sampleRate, blockSize, 2, params);
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            double elapsedMs = 0.0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, static_cast<float>(program[static_cast<size_t>(block * blockSize + i)]));
+
+                const auto start = Clock::now();
+                processor.process(buffer);
+                elapsedMs += millisecondsSince(start);
+            }
+
+            std::printf("  %-14s %8.2f ns/frame\n", names[static_cast<size_t>(mode)],
+                        elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * blockSize));
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double bias = argc > 1 ? juce::jlimit(0.0, 1.0, std::atof(argv[1])) : 0.3;
+    const int newtonIterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+
+    benchKernels(bias, newtonIterations);
+    benchEngine(bias);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Session-scale cache behaviour: many independent engines processed round robin
+// in small host blocks, as a DAW does with one instance per track. Reports time
+// and L1D / last-level cache misses per sample frame, with flutter off (no
+// delay slabs bound) and on.
+//
+//   ToBIAS_ManyInstanceBench [instances=256] [blockSize=64]
+//
+// Run the same binary built from an older tree to compare layouts. The miss
+// counts need perf events (Linux, perf_event_paranoid <= 2 and a kernel or
+// container that exposes the hardware counters); elsewhere they read n/a and
+// only the times mean anything.
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    using Engine = ProcessBlock<MarsDSP::ParameterValues>;
+
+    void run(int numInstances, int blockSize, float flutter)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int numRounds = 400;
+
+        std::vector<std::unique_ptr<MarsDSP::ParameterValues>> params;
+        std::vector<std::unique_ptr<Engine>> engines;
+        std::vector<juce::AudioBuffer<float>> buffers;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            params.push_back(std::make_unique<MarsDSP::ParameterValues>());
+            params.back()->set(MarsDSP::Param::flutter, flutter);
+
+            engines.push_back(std::make_unique<Engine>());
+            engines.back()->prepareDSP(sampleRate, static_cast<juce::uint32>(blockSize), 2, *params.back());
+
+            buffers.emplace_back(2, blockSize);
+        }
+
+        auto fill = [&](int round)
+        {
+            for (auto& buffer : buffers)
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, 0.5f * std::sin(0.01f * static_cast<float>(round * blockSize + i) + static_cast<float>(ch)));
+        };
+
+        // Warm up so slabs are bound and caches reflect steady state
+        for (int round = 0; round < 8; ++round)
+        {
+            fill(round);
+            for (int i = 0; i < numInstances; ++i)
+                engines[static_cast<size_t>(i)]->process(buffers[static_cast<size_t>(i)]);
+        }
+
+        CacheMissCounter l1Misses(CacheMissCounter::Level::l1Data);
+        CacheMissCounter llcMisses(CacheMissCounter::Level::lastLevel);
+
+        double elapsedMs = 0.0;
+        long long l1 = 0, llc = 0;
+
+        for (int round = 0; round < numRounds; ++round)
+        {
+            fill(round);
+
+            l1Misses.start();
+            llcMisses.start();
+            const auto start = Clock::now();
+
+            for (int i = 0; i < numInstances; ++i)
+                engines[static_cast<size_t>(i)]->process(buffers[static_cast<size_t>(i)]);
+
+            elapsedMs += millisecondsSince(start);
+            const auto roundL1 = l1Misses.stop();
+            const auto roundLlc = llcMisses.stop();
+
+            l1 = (roundL1 < 0 || l1 < 0) ? -1 : l1 + roundL1;
+            llc = (roundLlc < 0 || llc < 0) ? -1 : llc + roundLlc;
+        }
+
+        const double frames = static_cast<double>(numRounds) * numInstances * blockSize;
+
+        std::printf("flutter %-4s %8.2f ns/frame", flutter > 0.0f ? "on" : "off", elapsedMs * 1.0e6 / frames);
+
+        if (l1 >= 0)
+            std::printf("   L1D misses %7.3f/frame", static_cast<double>(l1) / frames);
+        else
+            std::printf("   L1D misses     n/a");
+
+        if (llc >= 0)
+            std::printf("   LLC misses %7.4f/frame\n", static_cast<double>(llc) / frames);
+        else
+            std::printf("   LLC misses     n/a\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int numInstances = argc > 1 ? std::max(1, std::atoi(argv[1])) : 256;
+    const int blockSize = argc > 2 ? std::max(1, std::atoi(argv[2])) : 64;
+
+    std::printf("%d instances, %d-sample blocks, sizeof(TapeDSP) = %zu bytes\n",
+                numInstances, blockSize, sizeof(TapeDSP));
+
+    run(numInstances, blockSize, 0.0f);
+    run(numInstances, blockSize, 0.5f);
+    return 0;
+}
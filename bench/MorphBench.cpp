@@ -0,0 +1,158 @@
+// Snapshot morphing: what a control-block update costs while settings change,
+// through the smoothers (coefficients designed on the audio thread every block)
+// and through SnapshotMorph (precomputed ends, blended), and how smooth a
+// preset change is either way.
+//
+// Smoothness is the largest sample-to-sample step of the output within the
+// transition, as a ratio of the largest step anywhere else in the run; a
+// glitch-free change stays near 1.
+//
+//   ToBIAS_MorphBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+    using ValueSet = std::array<float, MarsDSP::numParameters>;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int controlBlock = ProcessBlock<MarsDSP::ParameterValues>::controlBlockSize;
+    constexpr int hostBlock = 256;
+
+    ValueSet makeSnapshot(float amount)
+    {
+        ValueSet values {};
+
+        for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+            values[i] = MarsDSP::parameterTable[i].defaultValue;
+
+        values[MarsDSP::Param::input.index] = 0.3f + (0.6f * amount);
+        values[MarsDSP::Param::output.index] = 0.3f + (0.5f * amount);
+        values[MarsDSP::Param::tilt.index] = 0.2f + (0.6f * amount);
+        values[MarsDSP::Param::shape.index] = 0.2f + (0.7f * amount);
+        values[MarsDSP::Param::bias.index] = 0.2f + (0.6f * amount);
+        values[MarsDSP::Param::bumpHead.index] = 0.5f + (0.4f * amount);
+        values[MarsDSP::Param::bumpHz.index] = 40.0f + (100.0f * amount);
+        values[MarsDSP::Param::flutter.index] = 0.0f;
+        return values;
+    }
+
+    // ns per control-block update, averaged over a transition between a and b
+    void benchUpdateCost(const ValueSet& a, const ValueSet& b)
+    {
+        constexpr int numUpdates = 200000;
+
+        TapeDSP tape;
+        tape.prepare({ sampleRate, static_cast<juce::uint32>(controlBlock), 2 });
+
+        TapeDSP::ControlValues from, to, controls;
+        TapeDSP::readControls(a, from);
+        TapeDSP::readControls(b, to);
+
+        // Smoother path: controls change every block, everything is redesigned
+        auto start = Clock::now();
+
+        for (int u = 0; u < numUpdates; ++u)
+        {
+            const double t = static_cast<double>(u % 64) / 64.0;
+            controls = from;
+            controls.tilt += (to.tilt - from.tilt) * t;
+            controls.shape += (to.shape - from.shape) * t;
+            controls.bias += (to.bias - from.bias) * t;
+            controls.bumpHz += (to.bumpHz - from.bumpHz) * t;
+            tape.applyControls(controls, controlBlock);
+        }
+
+        const double smootherNs = millisecondsSince(start) * 1.0e6 / numUpdates;
+
+        // Morph path: ends worked out once, blended per block
+        MorphRequest request;
+        TapeDSP::computeCoefficients(from, sampleRate, request.from);
+        TapeDSP::computeCoefficients(to, sampleRate, request.to);
+        request.lengthSamples = 64 * controlBlock;
+
+        SnapshotMorph morph;
+        TapeDSP::CoefficientSet coefficients;
+
+        start = Clock::now();
+
+        for (int u = 0; u < numUpdates; ++u)
+        {
+            if (! morph.update())
+            {
+                morph.post(request);
+                morph.update();
+            }
+
+            morph.next(controlBlock, coefficients, controls);
+            tape.applyCoefficients(coefficients, controls, controlBlock);
+        }
+
+        const double morphNs = millisecondsSince(start) * 1.0e6 / numUpdates;
+
+        std::printf("Update per control block   smoothers %7.1f ns   morph %7.1f ns   %.1fx\n\n",
+                    smootherNs, morphNs, smootherNs / morphNs);
+    }
+
+    // seconds < 0 changes the parameters alone, through the smoothers
+    void benchSwitch(const ValueSet& a, const ValueSet& b, double seconds, const char* name)
+    {
+        constexpr int numBlocks = 300, switchBlock = 100, transitionBlocks = 60;
+
+        MarsDSP::ParameterValues params;
+        for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+            params.setValue(i, a[i]);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        std::vector<float> output;
+        output.reserve(static_cast<size_t>(numBlocks * hostBlock));
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (block == switchBlock)
+            {
+                if (seconds >= 0.0)
+                    processor.morphBetween(a, b, seconds);
+
+                for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+                    params.setValue(i, b[i]);
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < hostBlock; ++i)
+                    buffer.setSample(ch, i, 0.4f * std::sin(static_cast<float>((block * hostBlock) + i) * 0.01f));
+
+            processor.process(buffer);
+            output.insert(output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + hostBlock);
+        }
+
+        const auto at = static_cast<size_t>(switchBlock * hostBlock);
+        const auto end = at + static_cast<size_t>(transitionBlocks * hostBlock);
+        const double elsewhere = std::max(largestStep(output, static_cast<size_t>(20 * hostBlock), at),
+                                          largestStep(output, end, output.size()));
+
+        std::printf("%-22s %6.3f\n", name, largestStep(output, at - 1, end) / elsewhere);
+    }
+}
+
+int main()
+{
+    const auto a = makeSnapshot(0.0f);
+    const auto b = makeSnapshot(1.0f);
+
+    benchUpdateCost(a, b);
+
+    std::printf("Preset change          step in transition / elsewhere\n");
+    benchSwitch(a, b, -1.0, "smoothers (20-80 ms)");
+    benchSwitch(a, b, 0.002, "morph 2 ms");
+    benchSwitch(a, b, 0.05, "morph 50 ms");
+    benchSwitch(a, b, 0.2, "morph 200 ms");
+    return 0;
+}
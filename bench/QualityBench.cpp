@@ -0,0 +1,159 @@
+// Adaptive quality levels: what each level of qualityLevels saves, how smooth
+// a switch between levels is, and how QualityGovernor reacts to a load spike.
+//
+// The engine runs with everything the levels can cap turned up: second order
+// ADAA, Jiles-Atherton RK4, flutter, and the per-sample compander, which the
+// last level swaps for the multi-rate one. For the switch, the largest
+// sample-to-sample step within 10 ms of the switch is compared with the
+// largest step anywhere else in the program; crossfaded switches stay near 1.
+//
+//   ToBIAS_QualityBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int controlBlock = 32;
+    constexpr int numSamples = 48000 * 4;
+
+    void configure(MarsDSP::ParameterValues& params)
+    {
+        params.set(MarsDSP::Param::antialias, 2);
+        params.set(MarsDSP::Param::hysteresis, 2);
+        params.set(MarsDSP::Param::flutter, 0.6f);
+    }
+
+    std::vector<double> makeProgram(double phase)
+    {
+        std::vector<double> signal(static_cast<size_t>(numSamples));
+
+        for (size_t i = 0; i < signal.size(); ++i)
+        {
+            const double t = static_cast<double>(i) / sampleRate;
+            signal[i] = (0.5 * std::sin((2.0 * juce::MathConstants<double>::pi * 110.0 * t) + phase))
+                      + (0.2 * std::sin((2.0 * juce::MathConstants<double>::pi * 2350.0 * t) + phase));
+        }
+
+        return signal;
+    }
+
+    struct Run
+    {
+        double nsPerFrame = 0.0;
+        std::vector<double> left;
+    };
+
+    // Level before switchAt, toLevel from there on
+    Run run(int fromLevel, int toLevel, int switchAt)
+    {
+        MarsDSP::ParameterValues params;
+        configure(params);
+
+        const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(controlBlock), 2 };
+        MarsDSP::Smoother<MarsDSP::ParameterValues> smoother(params);
+        smoother.prepare(spec);
+        smoother.reset();
+
+        TapeDSP tape;
+        tape.prepare(spec);
+        tape.setQualityLevel(fromLevel);
+
+        const auto inL = makeProgram(0.0), inR = makeProgram(0.3);
+        Run result;
+        result.left.resize(static_cast<size_t>(numSamples));
+        std::vector<double> right(static_cast<size_t>(numSamples));
+
+        const auto start = Clock::now();
+
+        for (int offset = 0; offset < numSamples; offset += controlBlock)
+        {
+            if (offset == switchAt)
+                tape.setQualityLevel(toLevel);
+
+            smoother.update();
+            tape.processTape(inL.data() + offset, inR.data() + offset, result.left.data() + offset, right.data() + offset,
+                             controlBlock, smoother);
+        }
+
+        result.nsPerFrame = millisecondsSince(start) * 1.0e6 / numSamples;
+        return result;
+    }
+
+    void benchLevels()
+    {
+        std::printf("Level   ns/frame   vs full\n");
+
+        // Untimed pass so the first level does not pay for clock ramp-up
+        run(0, 0, -1);
+
+        std::array<double, numQualityLevels> times {};
+
+        for (int level = 0; level < numQualityLevels; ++level)
+            times[static_cast<size_t>(level)] = run(level, level, -1).nsPerFrame;
+
+        for (int level = 0; level < numQualityLevels; ++level)
+            std::printf("%5d   %8.1f   %6.2fx\n", level, times[static_cast<size_t>(level)], times[0] / times[static_cast<size_t>(level)]);
+    }
+
+    void benchSwitches()
+    {
+        constexpr int switchAt = numSamples / 2;
+        constexpr size_t window = static_cast<size_t>(sampleRate * 0.01);
+
+        std::printf("\nSwitch   step at switch / largest step elsewhere\n");
+
+        for (const auto& [from, to] : { std::pair { 0, 1 }, std::pair { 1, 2 }, std::pair { 2, 3 },
+                                        std::pair { 0, 3 }, std::pair { 3, 0 } })
+        {
+            const auto output = run(from, to, switchAt).left;
+            const size_t at = static_cast<size_t>(switchAt);
+
+            // Skip the first second, where the flutter delay is filling
+            const double elsewhere = std::max(largestStep(output, static_cast<size_t>(sampleRate), at - window),
+                                              largestStep(output, at + window, output.size()));
+
+            std::printf("%d -> %d   %6.3f\n", from, to, largestStep(output, at - window, at + window) / elsewhere);
+        }
+    }
+
+    // Synthetic load: idle, a two second overload, idle again. The load does
+    // not fall as the level drops, so this shows the timing of the steps only.
+    void benchGovernor()
+    {
+        constexpr int hostBlock = 256;
+        QualityGovernor governor;
+        governor.prepare(sampleRate);
+
+        std::printf("\nGovernor, %d-sample blocks\n  time   load in   level\n", hostBlock);
+
+        const double budget = hostBlock / sampleRate;
+        int lastLevel = -1;
+
+        for (int block = 0; block < static_cast<int>(12.0 * sampleRate / hostBlock); ++block)
+        {
+            const double t = block * budget;
+            const double load = (t >= 2.0 && t < 4.0) ? 0.8 : 0.2;
+            const int level = governor.update(load * budget, hostBlock, true);
+
+            if (level != lastLevel)
+            {
+                std::printf("%6.2fs   %7.2f   %5d\n", t, load, level);
+                lastLevel = level;
+            }
+        }
+    }
+}
+
+int main()
+{
+    benchLevels();
+    benchSwitches();
+    benchGovernor();
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Re-prepare: what a host reconfiguration costs and what it does to the audio,
+// with ProcessBlock keeping and rescaling its state, against clearing it with
+// reset() as every prepareDSP used to.
+//
+// Allocations are counted with a replaced global operator new over the
+// re-prepare and the first block after it. Smoothness is the largest
+// sample-to-sample step of the output in the 4096 samples after the change, as
+// a ratio of the largest step elsewhere in the run; a seamless change stays
+// near 1.
+//
+//   ToBIAS_ReprepareBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<long> numAllocations { 0 };
+}
+
+void* operator new(std::size_t size)
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr int numBlocks = 200, switchBlock = 100;
+
+    void configure(MarsDSP::ParameterValues& params)
+    {
+        params.set(MarsDSP::Param::input, 0.8f);
+        params.set(MarsDSP::Param::bumpHead, 0.8f);
+        params.set(MarsDSP::Param::flutter, 0.6f);
+    }
+
+    enum class Mode { none, reprepare, reset };
+
+    struct Result
+    {
+        std::vector<float> output;
+        long allocations = 0;
+        double switchMs = 0.0;
+    };
+
+    // A 220 Hz sine, continuous in time across the change from rateA and
+    // blockA to rateB and blockB at switchBlock
+    Result run(Mode mode, double rateA, int blockA, double rateB, int blockB)
+    {
+        // Same flutter randomness in every run
+        std::srand(1);
+
+        MarsDSP::ParameterValues params;
+        configure(params);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(rateA, static_cast<juce::uint32>(blockA), 2, params);
+
+        juce::AudioBuffer<float> buffer(2, std::max(blockA, blockB));
+        Result result;
+        double phase = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const bool after = block >= switchBlock;
+            const double rate = after ? rateB : rateA;
+            const int blockSize = after ? blockB : blockA;
+            buffer.setSize(2, blockSize, false, false, true);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto x = static_cast<float>(0.4 * std::sin(phase));
+                buffer.setSample(0, i, x);
+                buffer.setSample(1, i, x);
+                phase += juce::MathConstants<double>::twoPi * 220.0 / rate;
+            }
+
+            const auto start = Clock::now();
+            const long allocationsBefore = numAllocations.load();
+
+            if (block == switchBlock && mode == Mode::reprepare)
+                processor.prepareDSP(rateB, static_cast<juce::uint32>(blockB), 2, params);
+
+            if (block == switchBlock && mode == Mode::reset)
+            {
+                processor.prepareDSP(rateB, static_cast<juce::uint32>(blockB), 2, params);
+                processor.reset();
+            }
+
+            processor.process(buffer);
+
+            if (block == switchBlock)
+            {
+                result.allocations = numAllocations.load() - allocationsBefore;
+                result.switchMs = millisecondsSince(start);
+            }
+
+            result.output.insert(result.output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize);
+        }
+
+        return result;
+    }
+
+    double stepRatio(const Result& r, int blockA)
+    {
+        const auto at = static_cast<size_t>(switchBlock * blockA);
+        const double elsewhere = std::max(largestStep(r.output, static_cast<size_t>(20 * blockA), at),
+                                          largestStep(r.output, at + 4096, r.output.size()));
+
+        return largestStep(r.output, at - 1, at + 4096) / elsewhere;
+    }
+
+    double maxDifference(const Result& a, const Result& b)
+    {
+        double largest = 0.0;
+
+        for (size_t i = 0; i < std::min(a.output.size(), b.output.size()); ++i)
+            largest = std::max(largest, static_cast<double>(std::abs(a.output[i] - b.output[i])));
+
+        return largest;
+    }
+
+    void benchChange(const char* name, double rateA, int blockA, double rateB, int blockB)
+    {
+        const auto reference = run(Mode::none, rateA, blockA, rateB, blockB);
+        const auto reprepared = run(Mode::reprepare, rateA, blockA, rateB, blockB);
+        const auto cleared = run(Mode::reset, rateA, blockA, rateB, blockB);
+
+        std::printf("%s\n", name);
+        std::printf("  keep state   %3ld allocations   %7.3f ms   step ratio %6.3f   max diff to no change %.2e\n",
+                    reprepared.allocations, reprepared.switchMs, stepRatio(reprepared, blockA), maxDifference(reprepared, reference));
+        std::printf("  reset        %3ld allocations   %7.3f ms   step ratio %6.3f   max diff to no change %.2e\n\n",
+                    cleared.allocations, cleared.switchMs, stepRatio(cleared, blockA), maxDifference(cleared, reference));
+    }
+}
+
+int main()
+{
+    // Only the block size changes: keeping the state must be seamless
+    benchChange("48 kHz, block 512 -> 128", 48000.0, 512, 48000.0, 128);
+
+    // The rate changes too; max diff is only meaningful above
+    benchChange("44.1 kHz -> 48 kHz, block 256", 44100.0, 256, 48000.0, 256);
+    benchChange("96 kHz -> 48 kHz, block 256", 96000.0, 256, 48000.0, 256);
+    return 0;
+}
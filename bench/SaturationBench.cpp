@@ -0,0 +1,181 @@
+// Baked saturation curves: how far SaturationTables are from the direct sin
+// and cos of TapeDSP's saturation, what a sub-block of curve evaluations costs
+// each way, and what the table mode is worth over a whole ProcessBlock run.
+//
+// The error is measured on a dense sweep over +-4 (past both clamps) and
+// checked against the bound documented in SaturationTables.h; the bench exits
+// with 1 if it is exceeded.
+//
+//   ToBIAS_SaturationBench
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+#include <cstdlib>
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int hostBlock = 256;
+    constexpr double documentedBound = 9.5e-10;
+
+    // The direct curves, as written in TapeDSP::processSaturation
+    double directLows(double lows)
+    {
+        if (lows > 1.570796) lows = 1.570796;
+        if (lows < -1.570796) lows = -1.570796;
+        return std::sin(lows);
+    }
+
+    double directHighs(double highs)
+    {
+        double thinned = std::abs(highs) * 1.570796;
+        if (thinned > 1.570796) thinned = 1.570796;
+        thinned = 1.0 - std::cos(thinned);
+        if (highs < 0) thinned = -thinned;
+        return highs - thinned;
+    }
+
+    bool benchAccuracy()
+    {
+        constexpr int numPoints = 4000001;
+        const auto& tables = SaturationTables::get();
+
+        double lowsError = 0.0, highsError = 0.0;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            double x = -4.0 + (8.0 * i / (numPoints - 1));
+
+            double lows = x, highs = x;
+            tables.shapeLows(&lows, 1);
+            tables.thinHighs(&highs, 1);
+
+            lowsError = std::max(lowsError, std::abs(lows - directLows(x)));
+            highsError = std::max(highsError, std::abs(highs - directHighs(x)));
+        }
+
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        tables.shapeLows(&nan, 1);
+
+        const bool within = lowsError <= documentedBound && highsError <= documentedBound;
+
+        std::printf("Max error over +-4   sine lows %.2e   1 - cos highs %.2e   bound %.1e   %s\n\n",
+                    lowsError, highsError, documentedBound, within ? "within" : "EXCEEDED");
+        return within;
+    }
+
+    void benchCurves()
+    {
+        constexpr int blockSize = 64, numBlocks = 200000;
+        const auto& tables = SaturationTables::get();
+
+        alignas(64) std::array<double, blockSize> input {};
+        alignas(64) std::array<double, blockSize> lows {};
+        alignas(64) std::array<double, blockSize> highs {};
+
+        for (int i = 0; i < blockSize; ++i)
+            input[static_cast<size_t>(i)] = 1.8 * std::sin(i * 0.37);
+
+        double sink = 0.0;
+        auto start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                lows[index] = directLows(input[index] * (1.0 + b * 1.0e-9));
+                highs[index] = directHighs(input[index] * (1.0 + b * 1.0e-9));
+            }
+
+            sink += lows[static_cast<size_t>(b % blockSize)] + highs[static_cast<size_t>(b % blockSize)];
+        }
+
+        const double directNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+        start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                lows[index] = highs[index] = input[index] * (1.0 + b * 1.0e-9);
+            }
+
+            tables.shapeLows(lows.data(), blockSize);
+            tables.thinHighs(highs.data(), blockSize);
+            sink += lows[static_cast<size_t>(b % blockSize)] + highs[static_cast<size_t>(b % blockSize)];
+        }
+
+        const double tableNs = millisecondsSince(start) * 1.0e6 / (static_cast<double>(numBlocks) * blockSize);
+
+        std::printf("Both curves, ns/sample   direct %5.2f   table %5.2f   %.1fx   (sink %.3f)\n\n",
+                    directNs, tableNs, directNs / tableNs, sink);
+    }
+
+    struct Run
+    {
+        std::vector<float> output;
+        double nsPerFrame = 0.0;
+    };
+
+    Run run(SaturationMode mode)
+    {
+        constexpr int numBlocks = 4000;
+
+        std::srand(1);
+
+        MarsDSP::ParameterValues params;
+        params.set(MarsDSP::Param::input, 0.8f);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+        processor.setSaturationMode(mode);
+
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        Run result;
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < hostBlock; ++i)
+                    buffer.setSample(ch, i, 0.6f * std::sin(static_cast<float>((block * hostBlock) + i) * 0.013f));
+
+            const auto start = Clock::now();
+            processor.process(buffer);
+            elapsedMs += millisecondsSince(start);
+
+            result.output.insert(result.output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + hostBlock);
+        }
+
+        result.nsPerFrame = elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * hostBlock);
+        return result;
+    }
+
+    void benchProcess()
+    {
+        const auto direct = run(SaturationMode::direct);
+        const auto tabled = run(SaturationMode::table);
+
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < direct.output.size(); ++i)
+            maxDiff = std::max(maxDiff, static_cast<double>(std::abs(direct.output[i] - tabled.output[i])));
+
+        std::printf("ProcessBlock ns/frame   direct %6.1f   table %6.1f   %.2fx   max output diff %.1e\n",
+                    direct.nsPerFrame, tabled.nsPerFrame, direct.nsPerFrame / tabled.nsPerFrame, maxDiff);
+    }
+}
+
+int main()
+{
+    const bool within = benchAccuracy();
+    benchCurves();
+    benchProcess();
+    return within ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// Measures what a session pays per ToBIAS instance before any editor is opened:
+// construction time, prepareToPlay time and resident memory growth.
+//
+//   ToBIAS_StartupBench [instances=100]
+
+#include "PluginProcessor.h"
+#include "BenchUtils.h"
+
+int main(int argc, char* argv[])
+{
+    using namespace MarsDSP::Bench;
+
+    const int numInstances = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+
+    // The value tree state needs a message manager, as it would in a host
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto rssBefore = getResidentSetSize();
+
+    std::vector<std::unique_ptr<PluginProcessor>> instances;
+    instances.reserve(static_cast<size_t>(numInstances));
+
+    const auto constructStart = Clock::now();
+
+    for (int i = 0; i < numInstances; ++i)
+        instances.push_back(std::make_unique<PluginProcessor>());
+
+    const auto constructMs = millisecondsSince(constructStart);
+    const auto rssConstructed = getResidentSetSize();
+
+    const auto prepareStart = Clock::now();
+
+    for (auto& instance : instances)
+    {
+        instance->setRateAndBufferSizeDetails(48000.0, 512);
+        instance->prepareToPlay(48000.0, 512);
+    }
+
+    const auto prepareMs = millisecondsSince(prepareStart);
+    const auto rssPrepared = getResidentSetSize();
+
+    std::printf("web ui compiled in:   %s\n", JUCE_WEB_BROWSER ? "yes" : "no");
+    std::printf("instances:            %d\n", numInstances);
+    std::printf("construct total:      %.3f ms (%.3f ms/instance)\n", constructMs, constructMs / numInstances);
+    std::printf("prepare total:        %.3f ms (%.3f ms/instance)\n", prepareMs, prepareMs / numInstances);
+    std::printf("rss baseline:         %.2f MB\n", toMegabytes(rssBefore));
+    std::printf("rss after construct:  %.2f MB (+%.1f KB/instance)\n", toMegabytes(rssConstructed),
+                (static_cast<double>(rssConstructed) - static_cast<double>(rssBefore)) / 1024.0 / numInstances);
+    std::printf("rss after prepare:    %.2f MB (+%.1f KB/instance)\n", toMegabytes(rssPrepared),
+                (static_cast<double>(rssPrepared) - static_cast<double>(rssBefore)) / 1024.0 / numInstances);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Session save and load: the binary PluginState format against the XML it
+// replaced, over a session of many instances with differing settings. Save is
+// getStateInformation; load is setStateInformation on fresh instances, so the
+// binary path is timed on its own data and the XML path on the old format
+// (which setStateInformation still reads for older sessions).
+//
+//   ToBIAS_StateBench [instances=500]
+
+#include "PluginProcessor.h"
+#include "BenchUtils.h"
+
+namespace
+{
+    using namespace MarsDSP::Bench;
+
+    // What getStateInformation wrote before the binary format
+    void writeXmlState(PluginProcessor& processor, juce::MemoryBlock& destination)
+    {
+        juce::AudioProcessor::copyXmlToBinary(*processor.vts.copyState().createXml(), destination);
+    }
+
+    void randomise(PluginProcessor& processor, juce::Random& random)
+    {
+        for (auto* parameter : processor.getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+    }
+
+    bool sameValues(PluginProcessor& a, PluginProcessor& b)
+    {
+        const auto& pa = a.getParameters();
+        const auto& pb = b.getParameters();
+
+        for (int i = 0; i < pa.size(); ++i)
+            if (std::abs(pa[i]->getValue() - pb[i]->getValue()) > 1.0e-6f)
+                return false;
+
+        return true;
+    }
+
+    struct Result
+    {
+        double saveMs = 0.0, loadMs = 0.0;
+        size_t bytes = 0;
+        bool restored = true;
+    };
+
+    template <typename Writer>
+    Result run(std::vector<std::unique_ptr<PluginProcessor>>& session,
+               std::vector<std::unique_ptr<PluginProcessor>>& restored, Writer&& writer)
+    {
+        Result result;
+        std::vector<juce::MemoryBlock> blobs(session.size());
+
+        const auto saveStart = Clock::now();
+
+        for (size_t i = 0; i < session.size(); ++i)
+            writer(*session[i], blobs[i]);
+
+        result.saveMs = millisecondsSince(saveStart);
+
+        const auto loadStart = Clock::now();
+
+        for (size_t i = 0; i < session.size(); ++i)
+            restored[i]->setStateInformation(blobs[i].getData(), static_cast<int>(blobs[i].getSize()));
+
+        result.loadMs = millisecondsSince(loadStart);
+
+        for (size_t i = 0; i < session.size(); ++i)
+        {
+            result.bytes += blobs[i].getSize();
+            result.restored = result.restored && sameValues(*session[i], *restored[i]);
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int numInstances = argc > 1 ? std::max(1, std::atoi(argv[1])) : 500;
+
+    // The value tree state needs a message manager, as it would in a host
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::Random random(42);
+    std::vector<std::unique_ptr<PluginProcessor>> session, restored;
+
+    for (int i = 0; i < numInstances; ++i)
+    {
+        session.push_back(std::make_unique<PluginProcessor>());
+        restored.push_back(std::make_unique<PluginProcessor>());
+        randomise(*session.back(), random);
+    }
+
+    // Untimed pass so neither format pays for first-touch allocations
+    run(session, restored, [](PluginProcessor& p, juce::MemoryBlock& m) { p.getStateInformation(m); });
+
+    const auto xml = run(session, restored, writeXmlState);
+    const auto binary = run(session, restored, [](PluginProcessor& p, juce::MemoryBlock& m) { p.getStateInformation(m); });
+
+    std::printf("instances: %d\n\n", numInstances);
+    std::printf("Format   save ms   load ms   bytes/instance   restored\n");
+
+    for (const auto& [name, r] : { std::pair { "xml", xml }, std::pair { "binary", binary } })
+        std::printf("%-6s   %7.2f   %7.2f   %14zu   %8s\n", name, r.saveMs, r.loadMs,
+                    r.bytes / static_cast<size_t>(numInstances), r.restored ? "yes" : "NO");
+
+    std::printf("\nbinary vs xml: save %.1fx, load %.1fx, size %.1fx smaller\n",
+                xml.saveMs / binary.saveMs, xml.loadMs / binary.loadMs,
+                static_cast<double>(xml.bytes) / static_cast<double>(binary.bytes));
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Background coefficient rebuilds: what a control-block update costs when the
+// audio thread designs every filter itself and when it installs a set the
+// worker published, and what that is worth over a whole ProcessBlock run with
+// a real BackgroundWorker woken on the change. The output has to be identical either way.
+//
+//   ToBIAS_WorkerBench
+
+#include "ParameterValues.h"
+#include "BackgroundWorker.h"
+#include "DSP/ProcessDSP.h"
+#include "BenchUtils.h"
+
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+    using namespace MarsDSP::Bench;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int controlBlock = ProcessBlock<MarsDSP::ParameterValues>::controlBlockSize;
+    constexpr int hostBlock = 256;
+
+    void configure(MarsDSP::ParameterValues& params)
+    {
+        params.set(MarsDSP::Param::input, 0.7f);
+        params.set(MarsDSP::Param::bumpHead, 0.8f);
+        params.set(MarsDSP::Param::bias, 0.7f);
+    }
+
+    void benchUpdateCost()
+    {
+        constexpr int numUpdates = 200000;
+
+        MarsDSP::ParameterValues params;
+        configure(params);
+
+        std::array<float, MarsDSP::numParameters> values {};
+        for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+            values[i] = params.getValue(i);
+
+        TapeDSP tape;
+        tape.prepare({ sampleRate, static_cast<juce::uint32>(controlBlock), 2 });
+
+        TapeDSP::ControlValues controls;
+        TapeDSP::readControls(values, controls);
+
+        auto start = Clock::now();
+
+        for (int u = 0; u < numUpdates; ++u)
+            tape.applyControls(controls, controlBlock);
+
+        const double designNs = millisecondsSince(start) * 1.0e6 / numUpdates;
+
+        TapeDSP::CoefficientSet coefficients;
+        TapeDSP::computeCoefficients(controls, sampleRate, coefficients);
+
+        start = Clock::now();
+
+        for (int u = 0; u < numUpdates; ++u)
+            tape.applyCoefficients(coefficients, controls, controlBlock);
+
+        const double installNs = millisecondsSince(start) * 1.0e6 / numUpdates;
+
+        std::printf("Update per control block   designed %6.1f ns   installed %6.1f ns   %.1fx   (%.1f ns/frame per generation)\n\n",
+                    designNs, installNs, designNs / installNs, (designNs - installNs) / controlBlock);
+    }
+
+    struct Run
+    {
+        std::vector<float> output;
+        double nsPerFrame = 0.0;
+    };
+
+    // Settled parameters with one change half way, so both the ramp and the
+    // hand over to the worker's set are covered
+    Run run(bool withWorker, int generations)
+    {
+        constexpr int numBlocks = 2000;
+
+        std::srand(1);
+
+        MarsDSP::ParameterValues params;
+        configure(params);
+        params.set(MarsDSP::Param::generations, generations);
+
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        processor.prepareDSP(sampleRate, hostBlock, 2, params);
+
+        MarsDSP::BackgroundWorker worker;
+        MarsDSP::BackgroundWorker::Job job { [&processor] { processor.rebuildCoefficients(); } };
+
+        if (withWorker)
+        {
+            worker.add(job);
+
+            // Let the first set arrive, as it would during a host's prepare
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        juce::AudioBuffer<float> buffer(2, hostBlock);
+        Run result;
+        double elapsedMs = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (block == numBlocks / 2)
+            {
+                params.set(MarsDSP::Param::bumpHz, 110.0f);
+
+                // Keep the runs comparable: the change wakes the worker, which
+                // publishes before the smoothers settle on it
+                if (withWorker)
+                {
+                    job.wake();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < hostBlock; ++i)
+                    buffer.setSample(ch, i, 0.4f * std::sin(static_cast<float>((block * hostBlock) + i) * 0.013f));
+
+            const auto start = Clock::now();
+            processor.process(buffer);
+            elapsedMs += millisecondsSince(start);
+
+            result.output.insert(result.output.end(), buffer.getReadPointer(0), buffer.getReadPointer(0) + hostBlock);
+        }
+
+        worker.remove(job);
+        result.nsPerFrame = elapsedMs * 1.0e6 / (static_cast<double>(numBlocks) * hostBlock);
+        return result;
+    }
+
+    void benchProcess()
+    {
+        std::printf("Generations   audio thread ns/frame   with worker   speedup   max diff\n");
+
+        for (const int generations : { 1, 4, 8 })
+        {
+            const auto alone = run(false, generations);
+            const auto worked = run(true, generations);
+
+            double maxDiff = 0.0;
+            for (size_t i = 0; i < alone.output.size(); ++i)
+                maxDiff = std::max(maxDiff, static_cast<double>(std::abs(alone.output[i] - worked.output[i])));
+
+            std::printf("%11d   %21.1f   %11.1f   %6.2fx   %.1e\n", generations, alone.nsPerFrame, worked.nsPerFrame,
+                        alone.nsPerFrame / worked.nsPerFrame, maxDiff);
+        }
+    }
+}
+
+int main()
+{
+    benchUpdateCost();
+    benchProcess();
+    return 0;
+}
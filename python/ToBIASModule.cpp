@@ -0,0 +1,423 @@
+// Python/NumPy bindings for the headless tape engine (ToBIAS_DSP).
+//
+//   import numpy as np, tobias
+//
+//   engine = tobias.Engine(sample_rate=48000.0, max_block_size=512)
+//   engine.set_parameters(tilt=0.7, bias=0.4)
+//   engine.process(audio)            # (channels, samples) float32/float64, in place
+//
+//   clips = np.zeros((n, 2, samples), dtype=np.float32)
+//   params = np.tile(tobias.default_parameters(), (n, 1))
+//   tobias.process_batch(clips, 48000.0, params)    # in place, one engine per clip
+//   tobias.process_batch_lanes(clips, 48000.0, params)  # reduced chain, four clips per SIMD batch
+//
+// Buffers must be C-contiguous, writeable and of the exact dtype; nothing is
+// converted or copied. The GIL is released while audio is processed, and
+// process_batch spreads clips over worker threads.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "DSP/TapeBatch.h"
+
+#include <optional>
+#include <thread>
+
+namespace py = pybind11;
+
+namespace
+{
+    // Column order of the per-clip parameter matrix passed to process_batch:
+    // the continuous parameters, in registry order
+    constexpr auto parameterColumns = []
+    {
+        std::array<size_t, MarsDSP::numContinuousParameters> columns {};
+
+        for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+            if (MarsDSP::continuousIndex[i] < columns.size())
+                columns[MarsDSP::continuousIndex[i]] = i;
+
+        return columns;
+    }();
+
+    void setParameterRow(MarsDSP::ParameterValues& values, const float* row) noexcept
+    {
+        for (size_t i = 0; i < parameterColumns.size(); ++i)
+            values.setValue(parameterColumns[i], row[i]);
+    }
+
+    class Engine
+    {
+    public:
+        Engine(double sampleRate, int maxBlockSize)
+            : blockSize(maxBlockSize)
+        {
+            if (sampleRate <= 0.0 || maxBlockSize <= 0)
+                throw py::value_error("sample_rate and max_block_size must be positive");
+
+            prepare(sampleRate);
+        }
+
+        void prepare(double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            processor.prepareDSP(sampleRate, static_cast<juce::uint32>(blockSize), 2, params);
+        }
+
+        void reset() { processor.reset(); }
+
+        void setParameter(const std::string& name, float value)
+        {
+            const size_t index = MarsDSP::indexOfParameter(name);
+
+            if (index == MarsDSP::numParameters)
+                throw py::key_error("unknown parameter: " + name);
+
+            params.setValue(index, value);
+        }
+
+        void setParameterRow(const float* values) noexcept
+        {
+            ::setParameterRow(params, values);
+        }
+
+        py::dict getParameters() const
+        {
+            py::dict result;
+
+            for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+            {
+                const auto& spec = MarsDSP::parameterTable[i];
+                const float value = params.getValue(i);
+
+                if (spec.kind == MarsDSP::ParameterKind::choice || spec.kind == MarsDSP::ParameterKind::integer)
+                    result[spec.id] = static_cast<int>(value);
+                else if (spec.kind == MarsDSP::ParameterKind::toggle)
+                    result[spec.id] = value >= 0.5f;
+                else
+                    result[spec.id] = value;
+            }
+
+            return result;
+        }
+
+        // Processes channels x samples of contiguous audio in place, in chunks of
+        // at most max_block_size so parameter smoothing matches a host callback.
+        template <typename SampleType>
+        void processPlanar(SampleType* data, int numChannels, int numSamples) noexcept
+        {
+            std::array<SampleType*, 2> channels {};
+
+            for (int offset = 0; offset < numSamples; offset += blockSize)
+            {
+                const int chunk = std::min(blockSize, numSamples - offset);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    channels[static_cast<size_t>(ch)] = data + static_cast<size_t>(ch) * static_cast<size_t>(numSamples) + offset;
+
+                juce::AudioBuffer<SampleType> view(channels.data(), numChannels, chunk);
+                processor.process(view);
+            }
+        }
+
+        double getSampleRate() const noexcept { return sampleRate; }
+        int getBlockSize() const noexcept { return blockSize; }
+
+    private:
+
+        double sampleRate { 44100.0 };
+        int blockSize { 512 };
+
+        MarsDSP::ParameterValues params;
+        MarsDSP::DSP::ProcessBlock<MarsDSP::ParameterValues> processor;
+    };
+
+    template <typename SampleType>
+    using ArrayType = py::array_t<SampleType, py::array::c_style>;
+
+    template <typename SampleType>
+    void checkWriteable(const ArrayType<SampleType>& audio)
+    {
+        if (! audio.writeable())
+            throw py::value_error("audio buffer must be writeable");
+    }
+
+    // (samples,) or (channels, samples) with one or two channels
+    template <typename SampleType>
+    void processArray(Engine& engine, ArrayType<SampleType> audio)
+    {
+        checkWriteable(audio);
+
+        int numChannels = 1;
+        int numSamples = 0;
+
+        if (audio.ndim() == 1)
+        {
+            numSamples = static_cast<int>(audio.shape(0));
+        }
+        else if (audio.ndim() == 2)
+        {
+            numChannels = static_cast<int>(audio.shape(0));
+            numSamples = static_cast<int>(audio.shape(1));
+        }
+        else
+        {
+            throw py::value_error("expected a (samples,) or (channels, samples) array");
+        }
+
+        if (numChannels < 1 || numChannels > 2)
+            throw py::value_error("only mono and stereo buffers are supported");
+
+        auto* data = audio.mutable_data();
+
+        py::gil_scoped_release release;
+        engine.processPlanar(data, numChannels, numSamples);
+    }
+
+    // (clips, channels, samples), processed in place. Every clip gets a fresh
+    // engine so clips never share state; row i of params configures clip i.
+    template <typename SampleType>
+    void processBatch(ArrayType<SampleType> clips, double sampleRate,
+                      std::optional<py::array_t<float, py::array::c_style | py::array::forcecast>> params,
+                      int maxBlockSize, int numThreads)
+    {
+        checkWriteable(clips);
+
+        if (clips.ndim() != 3)
+            throw py::value_error("expected a (clips, channels, samples) array");
+
+        const auto numClips = static_cast<int>(clips.shape(0));
+        const auto numChannels = static_cast<int>(clips.shape(1));
+        const auto numSamples = static_cast<int>(clips.shape(2));
+
+        if (numChannels < 1 || numChannels > 2)
+            throw py::value_error("only mono and stereo clips are supported");
+
+        if (sampleRate <= 0.0 || maxBlockSize <= 0)
+            throw py::value_error("sample_rate and max_block_size must be positive");
+
+        const float* paramData = nullptr;
+
+        if (params.has_value())
+        {
+            if (params->ndim() != 2
+                || params->shape(0) != numClips
+                || params->shape(1) != static_cast<py::ssize_t>(parameterColumns.size()))
+                throw py::value_error("params must have shape (clips, " + std::to_string(parameterColumns.size()) + ")");
+
+            paramData = params->data();
+        }
+
+        if (numThreads <= 0)
+            numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        numThreads = std::min(numThreads, std::max(1, numClips));
+
+        auto* data = clips.mutable_data();
+        const auto clipStride = static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples);
+
+        py::gil_scoped_release release;
+
+        std::atomic<int> nextClip { 0 };
+
+        auto worker = [&]
+        {
+            for (int clip = nextClip.fetch_add(1); clip < numClips; clip = nextClip.fetch_add(1))
+            {
+                auto engine = std::make_unique<Engine>(sampleRate, maxBlockSize);
+
+                if (paramData != nullptr)
+                {
+                    engine->setParameterRow(paramData + static_cast<size_t>(clip) * parameterColumns.size());
+                    engine->reset();
+                }
+
+                engine->processPlanar(data + static_cast<size_t>(clip) * clipStride, numChannels, numSamples);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(static_cast<size_t>(numThreads - 1));
+
+        for (int i = 1; i < numThreads; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // Same contract as processBatch, but clips run through TapeBatch<8> four at
+    // a time, one lane per channel. Parameters are fixed per clip (no smoothing).
+    template <typename SampleType>
+    void processBatchLanes(ArrayType<SampleType> clips, double sampleRate,
+                           std::optional<py::array_t<float, py::array::c_style | py::array::forcecast>> params,
+                           int numThreads)
+    {
+        using Batch = MarsDSP::DSP::TapeBatch<8>;
+        constexpr int clipsPerBatch = Batch::numLanes / 2;
+
+        checkWriteable(clips);
+
+        if (clips.ndim() != 3)
+            throw py::value_error("expected a (clips, channels, samples) array");
+
+        const auto numClips = static_cast<int>(clips.shape(0));
+        const auto numChannels = static_cast<int>(clips.shape(1));
+        const auto numSamples = static_cast<int>(clips.shape(2));
+
+        if (numChannels < 1 || numChannels > 2)
+            throw py::value_error("only mono and stereo clips are supported");
+
+        if (sampleRate <= 0.0)
+            throw py::value_error("sample_rate must be positive");
+
+        const float* paramData = nullptr;
+
+        if (params.has_value())
+        {
+            if (params->ndim() != 2
+                || params->shape(0) != numClips
+                || params->shape(1) != static_cast<py::ssize_t>(parameterColumns.size()))
+                throw py::value_error("params must have shape (clips, " + std::to_string(parameterColumns.size()) + ")");
+
+            paramData = params->data();
+        }
+
+        const int numBatches = (numClips + clipsPerBatch - 1) / clipsPerBatch;
+
+        if (numThreads <= 0)
+            numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        numThreads = std::min(numThreads, std::max(1, numBatches));
+
+        auto* data = clips.mutable_data();
+        const auto clipStride = static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples);
+
+        py::gil_scoped_release release;
+
+        std::atomic<int> nextBatch { 0 };
+
+        auto worker = [&]
+        {
+            // The right lane of a mono clip reads silence and writes to scratch
+            std::vector<SampleType> silence(static_cast<size_t>(numChannels == 1 ? numSamples : 0));
+            std::vector<SampleType> scratch(silence.size());
+
+            for (int batchIndex = nextBatch.fetch_add(1); batchIndex < numBatches; batchIndex = nextBatch.fetch_add(1))
+            {
+                auto batch = std::make_unique<Batch>();
+                batch->prepare(sampleRate);
+
+                std::array<const SampleType*, Batch::numLanes> inputs {};
+                std::array<SampleType*, Batch::numLanes> outputs {};
+
+                const int firstClip = batchIndex * clipsPerBatch;
+                const int clipsHere = std::min(clipsPerBatch, numClips - firstClip);
+
+                for (int c = 0; c < clipsHere; ++c)
+                {
+                    MarsDSP::ParameterValues values;
+
+                    if (paramData != nullptr)
+                    {
+                        const float* row = paramData + static_cast<size_t>(firstClip + c) * parameterColumns.size();
+
+                        setParameterRow(values, row);
+                    }
+
+                    auto* clip = data + static_cast<size_t>(firstClip + c) * clipStride;
+
+                    for (int ch = 0; ch < 2; ++ch)
+                    {
+                        const auto lane = static_cast<size_t>(c * 2 + ch);
+                        batch->setParameters(static_cast<int>(lane), values);
+
+                        if (ch < numChannels)
+                        {
+                            inputs[lane] = clip + static_cast<size_t>(ch) * static_cast<size_t>(numSamples);
+                            outputs[lane] = clip + static_cast<size_t>(ch) * static_cast<size_t>(numSamples);
+                        }
+                        else
+                        {
+                            inputs[lane] = silence.data();
+                            outputs[lane] = scratch.data();
+                        }
+                    }
+                }
+
+                batch->process(inputs.data(), outputs.data(), numSamples, clipsHere * 2);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(static_cast<size_t>(numThreads - 1));
+
+        for (int i = 1; i < numThreads; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
+
+PYBIND11_MODULE(tobias, m)
+{
+    m.doc() = "ToBIAS tape engine: in-place, GIL-free processing of NumPy buffers";
+
+    py::list names;
+    for (const auto index : parameterColumns)
+        names.append(MarsDSP::parameterTable[index].id);
+    m.attr("PARAMETER_NAMES") = py::tuple(names);
+
+    m.def("default_parameters", []
+    {
+        MarsDSP::ParameterValues defaults;
+        py::array_t<float> row(static_cast<py::ssize_t>(parameterColumns.size()));
+        auto* out = row.mutable_data();
+
+        for (size_t i = 0; i < parameterColumns.size(); ++i)
+            out[i] = defaults.getValue(parameterColumns[i]);
+
+        return row;
+    }, "Default parameter row, in PARAMETER_NAMES order");
+
+    py::class_<Engine>(m, "Engine")
+        .def(py::init<double, int>(), py::arg("sample_rate") = 44100.0, py::arg("max_block_size") = 512)
+        .def("prepare", &Engine::prepare, py::arg("sample_rate"),
+             "Re-prepare for a new sample rate; tape state is kept and rescaled")
+        .def("reset", &Engine::reset, "Clear all tape state and snap smoothers to the current parameters")
+        .def("set_parameters", [](Engine& engine, const py::kwargs& kwargs)
+        {
+            for (const auto& item : kwargs)
+                engine.setParameter(py::cast<std::string>(item.first), py::cast<float>(item.second));
+        })
+        .def("get_parameters", &Engine::getParameters)
+        .def("process", &processArray<float>, py::arg("audio").noconvert())
+        .def("process", &processArray<double>, py::arg("audio").noconvert())
+        .def_property_readonly("sample_rate", &Engine::getSampleRate)
+        .def_property_readonly("max_block_size", &Engine::getBlockSize);
+
+    m.def("process_batch", &processBatch<float>,
+          py::arg("clips").noconvert(), py::arg("sample_rate"), py::arg("params") = py::none(),
+          py::arg("max_block_size") = 512, py::arg("num_threads") = 0);
+    m.def("process_batch", &processBatch<double>,
+          py::arg("clips").noconvert(), py::arg("sample_rate"), py::arg("params") = py::none(),
+          py::arg("max_block_size") = 512, py::arg("num_threads") = 0);
+
+    m.def("process_batch_lanes", &processBatchLanes<float>,
+          "Like process_batch on a reduced, unsmoothed chain, four clips per SIMD batch: no hiss stage, "
+          "classic flutter, slew limiter hysteresis and one generation, so the hiss, wow, capstan, scrape "
+          "and correlation columns are silently ignored",
+          py::arg("clips").noconvert(), py::arg("sample_rate"), py::arg("params") = py::none(),
+          py::arg("num_threads") = 0);
+    m.def("process_batch_lanes", &processBatchLanes<double>,
+          py::arg("clips").noconvert(), py::arg("sample_rate"), py::arg("params") = py::none(),
+          py::arg("num_threads") = 0);
+}
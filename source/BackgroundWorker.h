@@ -0,0 +1,171 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+namespace MarsDSP
+{
+    // ==============================================================================
+    // BACKGROUND WORKER
+    // ==============================================================================
+    //
+    // Rebuilds whatever is too expensive for the audio thread (filter designs,
+    // threshold ladders, tables) on a thread of its own, and hands the results
+    // over through Published slots.
+    //
+    // One worker serves the whole process: every processor holds it through a
+    // SharedResourcePointer and registers its own Job. Jobs are signalled rather
+    // than polled, so the thread sleeps until a parameter change wakes the job
+    // it concerns. Hosts may deliver those changes on the audio thread, where
+    // wake() costs an atomic store and, once per pass, one notify().
+
+    // Single writer, single reader handoff in the style of RCU: the writer
+    // fills a slot the reader is not using and publishes it with one atomic
+    // exchange, and the reader swaps in the newest slot with another. Until a
+    // newer value is published the reader keeps the last one it took. Three
+    // slots are built up front, so neither side waits or allocates.
+    template <typename T>
+    class Published
+    {
+    public:
+
+        Published() = default;
+        ~Published() = default;
+
+        // Writer: fill the slot returned by beginWrite, then publish it
+        T& beginWrite() noexcept { return slots[static_cast<size_t>(back)]; }
+
+        void publish() noexcept
+        {
+            back = latest.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+        }
+
+        // Reader: takes the newest published value, if there is one newer than
+        // the slot in use, and returns whether it did
+        bool update() noexcept
+        {
+            if ((latest.load(std::memory_order_relaxed) & freshBit) == 0)
+                return false;
+
+            front = latest.exchange(front, std::memory_order_acq_rel) & indexMask;
+            return true;
+        }
+
+        const T& read() const noexcept { return slots[static_cast<size_t>(front)]; }
+
+    private:
+
+        static constexpr int indexMask = 3, freshBit = 4;
+
+        std::array<T, 3> slots {};
+        std::atomic<int> latest { 1 };
+        int front = 0, back = 2;
+
+        JUCE_DECLARE_NON_COPYABLE(Published)
+    };
+
+    class BackgroundWorker : private juce::Thread
+    {
+    public:
+
+        // One unit of work, owned by whoever registers it. A job runs once when
+        // added and again after each wake(); it leaves the worker when destroyed.
+        class Job
+        {
+        public:
+
+            explicit Job(std::function<void()> work) : work(std::move(work)) {}
+            ~Job() { if (auto* owner = worker.load()) owner->remove(*this); }
+
+            // Any thread, the audio thread included: runs the job at the next
+            // pass. Signals the worker at most once per pass.
+            void wake() noexcept
+            {
+                pending.store(true, std::memory_order_release);
+
+                if (auto* owner = worker.load(std::memory_order_acquire))
+                    owner->signal();
+            }
+
+        private:
+
+            friend class BackgroundWorker;
+
+            std::function<void()> work;
+            std::atomic<bool> pending { true };
+            std::atomic<BackgroundWorker*> worker { nullptr };
+
+            JUCE_DECLARE_NON_COPYABLE(Job)
+        };
+
+        BackgroundWorker() : juce::Thread("ToBIAS worker") {}
+        ~BackgroundWorker() override { stopThread(1000); }
+
+        // Message thread. Starts the thread with the first job; adding a job
+        // that is already in only wakes it.
+        void add(Job& job)
+        {
+            {
+                const std::lock_guard<std::mutex> lock(jobsMutex);
+
+                if (job.worker.load() != this)
+                {
+                    jassert(job.worker.load() == nullptr);
+                    jobs.push_back(&job);
+                    job.worker.store(this, std::memory_order_release);
+                }
+            }
+
+            if (! isThreadRunning())
+                startThread();
+
+            job.wake();
+        }
+
+        // Message thread. Returns once the job is not running and never will again.
+        void remove(Job& job)
+        {
+            const std::lock_guard<std::mutex> lock(jobsMutex);
+
+            jobs.erase(std::remove(jobs.begin(), jobs.end(), &job), jobs.end());
+            job.worker.store(nullptr, std::memory_order_release);
+        }
+
+    private:
+
+        void signal() noexcept
+        {
+            if (! signalled.exchange(true, std::memory_order_acq_rel))
+                notify();
+        }
+
+        // Sleeps until a job is woken; no timeout, so an idle process costs
+        // nothing. The flag is cleared before the pass, so a wake that lands
+        // during it signals again and is not lost.
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                signalled.store(false, std::memory_order_release);
+
+                {
+                    const std::lock_guard<std::mutex> lock(jobsMutex);
+
+                    for (auto* job : jobs)
+                        if (job->pending.exchange(false, std::memory_order_acq_rel))
+                            job->work();
+                }
+
+                wait(-1);
+            }
+        }
+
+        std::mutex jobsMutex;
+        std::vector<Job*> jobs;
+        std::atomic<bool> signalled { false };
+
+        JUCE_DECLARE_NON_COPYABLE(BackgroundWorker)
+    };
+}
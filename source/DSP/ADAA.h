@@ -0,0 +1,234 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "SignalGuard.h"
+#include <cmath>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // ANTIDERIVATIVE ANTI-ALIASING
+    // ==============================================================================
+    //
+    // Memoryless curves used by TapeDSP, each with its first (F1) and second (F2)
+    // antiderivative. ADAAProcessor evaluates the curve as the average of the
+    // antiderivative over the last one or two input intervals, which suppresses
+    // aliasing without oversampling. First order adds half a sample of group
+    // delay, second order one sample; no latency is reported to the host.
+
+    enum class AntialiasMode
+    {
+        off,
+        firstOrder,
+        secondOrder
+    };
+
+    // Lows of processSaturation: sin(x), clamped to +-1 beyond +-pi/2
+    struct SineSaturationCurve
+    {
+        static constexpr double limit = 1.570796326794896619;
+
+        static double f(double x) noexcept
+        {
+            if (x > limit) return 1.0;
+            if (x < -limit) return -1.0;
+            return std::sin(x);
+        }
+
+        static double F1(double x) noexcept
+        {
+            if (std::abs(x) > limit)
+                return std::abs(x) - limit;
+
+            return -std::cos(x);
+        }
+
+        static double F2(double x) noexcept
+        {
+            if (x > limit)
+            {
+                const double d = x - limit;
+                return (d * d * 0.5) - 1.0;
+            }
+
+            if (x < -limit)
+            {
+                const double d = x + limit;
+                return 1.0 - (d * d * 0.5);
+            }
+
+            return -std::sin(x);
+        }
+    };
+
+    // Highs of processSaturation: h - sign(h) * (1 - cos(|h| * pi/2)), with the
+    // cosine argument clamped at pi/2 (so h - sign(h) beyond |h| = 1)
+    struct CosineThinningCurve
+    {
+        static constexpr double halfPi = 1.570796326794896619;
+        static constexpr double twoOverPi = 0.636619772367581343;
+        static constexpr double fourOverPiSquared = 0.405284734569351086;
+
+        static double f(double x) noexcept
+        {
+            const double a = std::abs(x);
+            const double thinned = a >= 1.0 ? 1.0 : 1.0 - std::cos(a * halfPi);
+            return x < 0.0 ? x + thinned : x - thinned;
+        }
+
+        static double F1(double x) noexcept
+        {
+            const double a = std::abs(x);
+            const double thinnedIntegral = a >= 1.0 ? a - twoOverPi
+                                                    : a - (twoOverPi * std::sin(a * halfPi));
+            return (x * x * 0.5) - thinnedIntegral;
+        }
+
+        static double F2(double x) noexcept
+        {
+            const double a = std::abs(x);
+            double thinnedIntegral;
+
+            if (a >= 1.0)
+                thinnedIntegral = (0.5 - fourOverPiSquared) + ((a * a - 1.0) * 0.5) - (twoOverPi * (a - 1.0));
+            else
+                thinnedIntegral = (a * a * 0.5) + (fourOverPiSquared * (std::cos(a * halfPi) - 1.0));
+
+            if (x < 0.0)
+                thinnedIntegral = -thinnedIntegral;
+
+            return (x * x * x / 6.0) - thinnedIntegral;
+        }
+    };
+
+    // Ceiling of processSoftClip (the level its stateful clipper settles at)
+    struct HardClipCurve
+    {
+        static constexpr double ceiling = 0.9549925859;
+
+        static double f(double x) noexcept
+        {
+            if (x > ceiling) return ceiling;
+            if (x < -ceiling) return -ceiling;
+            return x;
+        }
+
+        static double F1(double x) noexcept
+        {
+            const double a = std::abs(x);
+            if (a > ceiling)
+                return (ceiling * a) - (ceiling * ceiling * 0.5);
+            return x * x * 0.5;
+        }
+
+        static double F2(double x) noexcept
+        {
+            const double a = std::abs(x);
+            if (a > ceiling)
+            {
+                const double value = (ceiling * a * a * 0.5) - (ceiling * ceiling * a * 0.5) + (ceiling * ceiling * ceiling / 6.0);
+                return x < 0.0 ? -value : value;
+            }
+            return x * x * x / 6.0;
+        }
+    };
+
+    template <typename Curve>
+    class ADAAProcessor
+    {
+    public:
+
+        void reset() noexcept
+        {
+            x1 = x2 = 0.0;
+        }
+
+        bool isFinite() const noexcept { return allFinite(x1, x2); }
+
+        // Records an input that was shaped elsewhere (the non-antialiased path)
+        void track(double x) noexcept
+        {
+            x2 = x1;
+            x1 = x;
+        }
+
+        // Inputs are always tracked, so switching modes mid-stream starts from
+        // valid history instead of a transient.
+        double process(double x, AntialiasMode mode) noexcept
+        {
+            const double y = evaluate(x, mode);
+
+            x2 = x1;
+            x1 = x;
+            return y;
+        }
+
+        // Both modes from the same history, mixed; mix runs 0 (from) to 1 (to)
+        // across a crossfade between antialiasing orders
+        double processBlend(double x, AntialiasMode from, AntialiasMode to, double mix) noexcept
+        {
+            const double a = evaluate(x, from);
+            const double y = a + ((evaluate(x, to) - a) * mix);
+
+            x2 = x1;
+            x1 = x;
+            return y;
+        }
+
+    private:
+
+        double evaluate(double x, AntialiasMode mode) const noexcept
+        {
+            switch (mode)
+            {
+                case AntialiasMode::firstOrder:  return processFirstOrder(x);
+                case AntialiasMode::secondOrder: return processSecondOrder(x);
+                case AntialiasMode::off:
+                default:                         return Curve::f(x);
+            }
+        }
+
+        static constexpr double tolerance = 1.0e-5;
+
+        double processFirstOrder(double x) const noexcept
+        {
+            const double delta = x - x1;
+
+            if (std::abs(delta) < tolerance)
+                return Curve::f((x + x1) * 0.5);
+
+            return (Curve::F1(x) - Curve::F1(x1)) / delta;
+        }
+
+        // First divided difference of F2, falling back to F1 at the midpoint
+        static double firstDifference(double a, double b) noexcept
+        {
+            const double delta = a - b;
+
+            if (std::abs(delta) < tolerance)
+                return Curve::F1((a + b) * 0.5);
+
+            return (Curve::F2(a) - Curve::F2(b)) / delta;
+        }
+
+        double processSecondOrder(double x) const noexcept
+        {
+            const double delta = x - x2;
+
+            if (std::abs(delta) >= tolerance)
+                return (2.0 / delta) * (firstDifference(x, x1) - firstDifference(x1, x2));
+
+            // x ~= x2: expand around their midpoint
+            const double mid = (x + x2) * 0.5;
+            const double deltaMid = mid - x1;
+
+            if (std::abs(deltaMid) < tolerance)
+                return Curve::f((mid + x1) * 0.5);
+
+            return (2.0 / deltaMid) * (Curve::F1(mid) + ((Curve::F2(x1) - Curve::F2(mid)) / deltaMid));
+        }
+
+        double x1 = 0.0;
+        double x2 = 0.0;
+    };
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <DSPIncludes.h>
+
+namespace MarsDSP::DSP
+{
+    // Octave bands of the spectrum in AnalysisFrame, by centre frequency
+    inline constexpr std::array<float, 8> analysisBandCentres { 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f };
+
+    // One display column: the input and output envelopes over samplesPerColumn
+    // samples, the output at the input's two extremes (points on the transfer
+    // curve), the flutter pitch deviation and the output's mean square in each
+    // octave band of analysisBandCentres.
+    struct AnalysisFrame
+    {
+        float inMin, inMax;
+        float outMin, outMax;
+        float outAtInMin, outAtInMax;
+        float pitchCents;
+        std::array<float, analysisBandCentres.size()> bandPower;
+    };
+
+    // Wait-free single producer / single consumer link from the audio thread to
+    // an editor. The audio thread folds samples into AnalysisFrames, one per
+    // pixel column, and pushes whole frames; raw audio never crosses. While
+    // inactive the producer side is one relaxed load per block. When the FIFO
+    // is full, frames are dropped rather than waited for. The FIFO is only
+    // allocated by the first start(), so an engine nobody watches (headless,
+    // Python, the tools) carries none of it.
+    class AnalysisTap
+    {
+    public:
+
+        static constexpr int capacity = 4096;
+
+        AnalysisTap() = default;
+        ~AnalysisTap() = default;
+
+        //==============================================================================
+        // Consumer (message thread)
+
+        // Discards whatever an earlier session left behind, then starts the feed.
+        // The frames are allocated here, before the producer can see them, and
+        // kept until the tap goes.
+        void start(int newSamplesPerColumn)
+        {
+            setSamplesPerColumn(newSamplesPerColumn);
+
+            if (frames == nullptr)
+                frames = std::make_unique<AnalysisFrame[]>(capacity);
+
+            while (pop(nullptr, capacity) > 0) {}
+
+            active.store(true, std::memory_order_release);
+        }
+
+        void stop() noexcept { active.store(false, std::memory_order_relaxed); }
+
+        void setSamplesPerColumn(int newSamplesPerColumn) noexcept
+        {
+            requestedSamplesPerColumn.store(juce::jmax(1, newSamplesPerColumn), std::memory_order_relaxed);
+        }
+
+        // Copies up to maxFrames frames into destination (or just drops them
+        // when destination is null) and returns how many there were
+        int pop(AnalysisFrame* destination, int maxFrames) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(maxFrames, start1, size1, start2, size2);
+
+            if (destination != nullptr && frames != nullptr)
+            {
+                std::copy_n(frames.get() + start1, size1, destination);
+                std::copy_n(frames.get() + start2, size2, destination + size1);
+            }
+
+            fifo.finishedRead(size1 + size2);
+            return size1 + size2;
+        }
+
+        //==============================================================================
+        // Producer (audio thread)
+
+        // Once per host block; false when there is no consumer. A column left
+        // half full from an earlier session is thrown away.
+        bool beginBlock(double sampleRate) noexcept
+        {
+            const bool isActive = active.load(std::memory_order_acquire);
+
+            if (isActive && ! wasActive)
+            {
+                samplesPerColumn = requestedSamplesPerColumn.load(std::memory_order_relaxed);
+                startColumn();
+                hasFlutterOffset = false;
+
+                for (auto& band : bands)
+                    band.s1 = band.s2 = 0.0f;
+            }
+
+            if (isActive && sampleRate != bandSampleRate)
+            {
+                for (size_t b = 0; b < bands.size(); ++b)
+                    bands[b].design(analysisBandCentres[b], sampleRate);
+
+                bandSampleRate = sampleRate;
+            }
+
+            wasActive = isActive;
+            return isActive;
+        }
+
+        // flutterOffset is the flutter delay read offset at the end of the
+        // stretch; its slope over the stretch is the pitch deviation
+        template <typename SampleType>
+        void push(const SampleType* in, const SampleType* out, int numSamples, double flutterOffset) noexcept
+        {
+            const auto rate = hasFlutterOffset ? (flutterOffset - lastFlutterOffset) / static_cast<double>(numSamples) : 0.0;
+            lastFlutterOffset = flutterOffset;
+            hasFlutterOffset = true;
+
+            // Reading ahead in the ring shortens the delay, which raises the pitch
+            const auto pitchCents = static_cast<float>(1200.0 * std::log2(juce::jmax(1.0e-3, 1.0 + rate)));
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto x = static_cast<float>(in[i]);
+                const auto y = static_cast<float>(out[i]);
+
+                if (x < column.inMin) { column.inMin = x; column.outAtInMin = y; }
+                if (x > column.inMax) { column.inMax = x; column.outAtInMax = y; }
+
+                column.outMin = juce::jmin(column.outMin, y);
+                column.outMax = juce::jmax(column.outMax, y);
+
+                for (size_t b = 0; b < bands.size(); ++b)
+                {
+                    const auto band = bands[b].process(y);
+                    column.bandPower[b] += band * band;
+                }
+
+                if (++columnSamples == samplesPerColumn)
+                {
+                    column.pitchCents = pitchCents;
+
+                    for (auto& power : column.bandPower)
+                        power /= static_cast<float>(samplesPerColumn);
+
+                    publish();
+
+                    samplesPerColumn = requestedSamplesPerColumn.load(std::memory_order_relaxed);
+                    startColumn();
+                }
+            }
+        }
+
+    private:
+
+        // Octave-wide band-pass with unity gain at the centre, transposed
+        // direct form II
+        struct Band
+        {
+            float b0 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+            float s1 = 0.0f, s2 = 0.0f;
+
+            void design(float centre, double sampleRate) noexcept
+            {
+                constexpr double q = 1.41;
+                const double w = juce::MathConstants<double>::twoPi * juce::jmin(static_cast<double>(centre), 0.45 * sampleRate) / sampleRate;
+                const double alpha = std::sin(w) / (2.0 * q);
+                const double norm = 1.0 / (1.0 + alpha);
+
+                b0 = static_cast<float>(alpha * norm);
+                a1 = static_cast<float>(-2.0 * std::cos(w) * norm);
+                a2 = static_cast<float>((1.0 - alpha) * norm);
+            }
+
+            float process(float x) noexcept
+            {
+                const float y = (b0 * x) + s1;
+                s1 = s2 - (a1 * y);
+                s2 = -(b0 * x) - (a2 * y);
+                return y;
+            }
+        };
+
+        void startColumn() noexcept
+        {
+            column = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+                       std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+                       0.0f, 0.0f, 0.0f, {} };
+            columnSamples = 0;
+        }
+
+        void publish() noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+            if (size1 == 0)
+                return;
+
+            frames[static_cast<size_t>(start1)] = column;
+            fifo.finishedWrite(1);
+        }
+
+        // Allocated by start, so an idle tap adds nothing to the engine's footprint
+        juce::AbstractFifo fifo { capacity };
+        std::unique_ptr<AnalysisFrame[]> frames;
+
+        std::atomic<bool> active { false };
+        std::atomic<int> requestedSamplesPerColumn { 64 };
+
+        // Producer-only state
+        AnalysisFrame column {};
+        std::array<Band, analysisBandCentres.size()> bands;
+        double bandSampleRate = 0.0;
+        int samplesPerColumn = 64, columnSamples = 0;
+        double lastFlutterOffset = 0.0;
+        bool hasFlutterOffset = false, wasActive = false;
+
+        JUCE_DECLARE_NON_COPYABLE(AnalysisTap)
+    };
+}
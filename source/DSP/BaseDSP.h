@@ -1,6 +1,6 @@
 #pragma once
 
-#include <Includes.h>
+#include <DSPIncludes.h>
 #include "Smoother.h"
 
 namespace MarsDSP::DSP
@@ -37,15 +37,9 @@ namespace MarsDSP::DSP
 
         virtual float processSample(float xn_input, int channel) = 0;
 
-        virtual float getInput(size_t channel = 0)        { return smoother.getInput(channel); }
-        virtual float getTilt(size_t channel = 0)         { return smoother.getTilt(channel); }
-        virtual float getShape(size_t channel = 0)        { return smoother.getShape(channel); }
-        virtual float getBias(size_t channel = 0)         { return smoother.getBias(channel); }
-        virtual float getFlutter(size_t channel = 0)      { return smoother.getFlutter(channel); }
-        virtual float getFlutterSpeed(size_t channel = 0) { return smoother.getFlutterSpeed(channel); }
-        virtual float getBumpHead(size_t channel = 0)     { return smoother.getBumpHead(channel); }
-        virtual float getBumpHz(size_t channel = 0)       { return smoother.getBumpHz(channel); }
-        virtual float getOutput(size_t channel = 0)       { return smoother.getOutput(channel); }
+        // Next smoothed value of a continuous parameter, e.g. next(Param::tilt)
+        template <size_t Index>
+        float next(ParameterTag<Index> tag, size_t channel = 0) { return smoother.next(tag, channel); }
 
     private:
 
@@ -0,0 +1,17 @@
+// Translation unit for the headless ToBIAS_DSP static library. The engine is
+// header-only, so this instantiates it once against ParameterValues and gives
+// the library its own copy of juce_core, juce_audio_basics and juce_dsp.
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+#include "DSP/TapeBatch.h"
+
+template class MarsDSP::Smoother<MarsDSP::ParameterValues>;
+template class MarsDSP::DSP::ProcessBlock<MarsDSP::ParameterValues>;
+template void MarsDSP::DSP::ProcessBlock<MarsDSP::ParameterValues>::process<float>(juce::AudioBuffer<float>&);
+template void MarsDSP::DSP::ProcessBlock<MarsDSP::ParameterValues>::process<double>(juce::AudioBuffer<double>&);
+
+template class MarsDSP::DSP::TapeBatch<4>;
+template class MarsDSP::DSP::TapeBatch<8>;
+template void MarsDSP::DSP::TapeBatch<8>::process<float>(const float* const*, float* const*, int, int);
+template void MarsDSP::DSP::TapeBatch<8>::process<double>(const double* const*, double* const*, int, int);
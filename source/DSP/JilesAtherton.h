@@ -0,0 +1,254 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "SignalGuard.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // JILES-ATHERTON HYSTERESIS
+    // ==============================================================================
+    //
+    // Physically modelled alternative to the slew limiter cascade in
+    // HysteresisProcessor. The input is taken as the applied field H and the
+    // magnetisation M follows the Jiles-Atherton ODE
+    //
+    //   dM/dt = f(M, H, dH/dt)
+    //
+    // integrated once per sample by the selected solver:
+    //   rk2           - midpoint, two evaluations
+    //   rk4           - classic Runge-Kutta, four evaluations
+    //   newtonRaphson - trapezoidal rule solved with a fixed number of Newton
+    //                   iterations (one evaluation plus derivative each)
+    //
+    // Both channels run as two lanes of the same loop. Everything that depends on
+    // the bias and sample rate only is folded into Constants once per block.
+
+    enum class HysteresisSolver
+    {
+        rk2,
+        rk4,
+        newtonRaphson
+    };
+
+    class JilesAthertonHysteresis
+    {
+    public:
+
+        static constexpr int lanes = 2;
+
+        void reset() noexcept
+        {
+            magnetisation.fill(0.0);
+            field.fill(0.0);
+            fieldDerivative.fill(0.0);
+        }
+
+        bool isFinite() const noexcept
+        {
+            return allFiniteIn(magnetisation) && allFiniteIn(field) && allFiniteIn(fieldDerivative);
+        }
+
+        // For containment tests: NaN in the left lane's magnetisation
+        void poisonState() noexcept { magnetisation[0] = std::numeric_limits<double>::quiet_NaN(); }
+
+        void setSolver(HysteresisSolver newSolver) noexcept { solver = newSolver; }
+        HysteresisSolver getSolver() const noexcept { return solver; }
+
+        // Newton iterations per sample for HysteresisSolver::newtonRaphson
+        void setNewtonIterations(int iterations) noexcept { newtonIterations = juce::jmax(1, iterations); }
+
+        // Maps the Bias parameter onto the loop: under-biased tape gets a wide,
+        // mostly irreversible loop, over-biased tape a narrow, reversible one.
+        // Cheap to call every block; the constants are only rebuilt on change.
+        void updateConstants(double bias, double sampleRate) noexcept
+        {
+            if (bias == cookedBias && sampleRate == cookedSampleRate)
+                return;
+
+            cookedBias = bias;
+            cookedSampleRate = sampleRate;
+
+            const double formattedBias = (bias * 2.0) - 1.0;
+            const double width = 0.5 * (1.0 - formattedBias);
+
+            auto& k = constants;
+            k.Ms = 1.0;
+            k.a = k.Ms / (0.01 + 6.0 * 0.5);
+            k.alpha = 1.6e-3;
+            k.k = 0.47875 * (0.5 + width);
+            k.c = juce::jmax(0.05, std::sqrt(1.0 - width) - 0.01);
+            k.oneMinusC = 1.0 - k.c;
+
+            k.alphaOverA = k.alpha / k.a;
+            k.msOverA = k.Ms / k.a;
+            k.cMsOverA = k.c * k.msOverA;
+            k.cAlphaMsOverA = k.alpha * k.cMsOverA;
+
+            k.T = 1.0 / sampleRate;
+            k.halfT = 0.5 * k.T;
+            k.derivativeGain = (1.0 + derivativeAlpha) / k.T;
+
+            // Unity small-signal gain on the anhysteretic curve, partly making up
+            // the sensitivity a low reversibility c loses at low bias
+            const double chi = (k.msOverA / 3.0) / (1.0 - (k.alpha * k.msOverA / 3.0));
+            k.outputScale = 1.0 / (chi * std::sqrt(k.c));
+        }
+
+        // In place over numSamples of each channel
+        void process(double* left, double* right, int numSamples) noexcept
+        {
+            switch (solver)
+            {
+                case HysteresisSolver::rk2:             processBlock<HysteresisSolver::rk2>(left, right, numSamples); break;
+                case HysteresisSolver::rk4:             processBlock<HysteresisSolver::rk4>(left, right, numSamples); break;
+                case HysteresisSolver::newtonRaphson:   processBlock<HysteresisSolver::newtonRaphson>(left, right, numSamples); break;
+                default: break;
+            }
+        }
+
+    private:
+
+        struct Constants
+        {
+            double Ms = 1.0, a = 1.0, alpha = 0.0, k = 1.0, c = 1.0, oneMinusC = 0.0;
+            double alphaOverA = 0.0, msOverA = 1.0, cMsOverA = 1.0, cAlphaMsOverA = 0.0;
+            double T = 1.0 / 44100.0, halfT = 0.5 / 44100.0, derivativeGain = 0.0;
+            double outputScale = 1.0;
+        };
+
+        using LaneArray = std::array<double, lanes>;
+
+        // Blend between a trapezoidal (1) and backward (0) differentiator for dH/dt;
+        // the pure trapezoid rings at Nyquist
+        static constexpr double derivativeAlpha = 0.75;
+
+        // dM/dt, and optionally its partial derivative in M for Newton-Raphson
+        template <bool withDerivative>
+        static double evaluate(const Constants& k, double M, double H, double dH, double* derivative = nullptr) noexcept
+        {
+            const double Q = (H + (k.alpha * M)) / k.a;
+            const bool nearZero = std::abs(Q) < 1.0e-3;
+
+            const double coth = 1.0 / std::tanh(nearZero ? 1.0 : Q);
+            const double inverseQ = 1.0 / (nearZero ? 1.0 : Q);
+
+            // Langevin function and its first two derivatives
+            const double langevin = nearZero ? Q / 3.0 : coth - inverseQ;
+            const double langevinD1 = nearZero ? 1.0 / 3.0 : (inverseQ * inverseQ) - (coth * coth) + 1.0;
+
+            const double Mdiff = (k.Ms * langevin) - M;
+            const double delta = dH >= 0.0 ? 1.0 : -1.0;
+            const double deltaM = (delta > 0.0) == (Mdiff > 0.0) ? 1.0 : 0.0;
+
+            const double irreversibleDenominator = (k.oneMinusC * delta * k.k) - (k.alpha * Mdiff);
+            const double irreversible = ((k.oneMinusC * deltaM * Mdiff) / irreversibleDenominator) * dH;
+            const double reversible = k.cMsOverA * dH * langevinD1;
+            const double denominator = 1.0 - (k.cAlphaMsOverA * langevinD1);
+
+            const double dMdt = (irreversible + reversible) / denominator;
+
+            if constexpr (withDerivative)
+            {
+                const double langevinD2 = nearZero ? -2.0 * Q / 15.0
+                                                   : (2.0 * coth * ((coth * coth) - 1.0)) - (2.0 * inverseQ * inverseQ * inverseQ);
+
+                const double dMdiff = (k.Ms * langevinD1 * k.alphaOverA) - 1.0;
+                const double dIrreversible = (k.oneMinusC * deltaM * dH * k.oneMinusC * delta * k.k * dMdiff)
+                                           / (irreversibleDenominator * irreversibleDenominator);
+                const double dReversible = k.cMsOverA * dH * langevinD2 * k.alphaOverA;
+                const double dDenominator = -k.cAlphaMsOverA * langevinD2 * k.alphaOverA;
+
+                *derivative = (((dIrreversible + dReversible) * denominator) - ((irreversible + reversible) * dDenominator))
+                            / (denominator * denominator);
+            }
+
+            return dMdt;
+        }
+
+        template <HysteresisSolver method>
+        void processBlock(double* left, double* right, int numSamples) noexcept
+        {
+            const Constants k = constants;
+            LaneArray M = magnetisation, Hprev = field, dHprev = fieldDerivative;
+            std::array<double*, lanes> io { left, right };
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                for (int lane = 0; lane < lanes; ++lane)
+                {
+                    const double H = io[static_cast<size_t>(lane)][i];
+                    const double dH = (k.derivativeGain * (H - Hprev[lane])) - (derivativeAlpha * dHprev[lane]);
+
+                    double next = M[lane];
+
+                    if constexpr (method == HysteresisSolver::rk2)
+                    {
+                        const double Hmid = 0.5 * (H + Hprev[lane]);
+                        const double dHmid = 0.5 * (dH + dHprev[lane]);
+
+                        const double k1 = k.T * evaluate<false>(k, M[lane], Hprev[lane], dHprev[lane]);
+                        const double k2 = k.T * evaluate<false>(k, M[lane] + 0.5 * k1, Hmid, dHmid);
+                        next = M[lane] + k2;
+                    }
+
+                    else if constexpr (method == HysteresisSolver::rk4)
+                    {
+                        const double Hmid = 0.5 * (H + Hprev[lane]);
+                        const double dHmid = 0.5 * (dH + dHprev[lane]);
+
+                        const double k1 = k.T * evaluate<false>(k, M[lane], Hprev[lane], dHprev[lane]);
+                        const double k2 = k.T * evaluate<false>(k, M[lane] + 0.5 * k1, Hmid, dHmid);
+                        const double k3 = k.T * evaluate<false>(k, M[lane] + 0.5 * k2, Hmid, dHmid);
+                        const double k4 = k.T * evaluate<false>(k, M[lane] + k3, H, dH);
+                        next = M[lane] + ((k1 + (2.0 * k2) + (2.0 * k3) + k4) / 6.0);
+                    }
+
+                    else
+                    {
+                        // M = M[n-1] + T/2 (f(M) + f(M[n-1])), from an Euler predictor
+                        const double previousSlope = evaluate<false>(k, M[lane], Hprev[lane], dHprev[lane]);
+                        const double base = M[lane] + (k.halfT * previousSlope);
+                        next = M[lane] + (k.T * previousSlope);
+
+                        for (int iteration = 0; iteration < newtonIterations; ++iteration)
+                        {
+                            double slopeDerivative = 0.0;
+                            const double slope = evaluate<true>(k, next, H, dH, &slopeDerivative);
+                            const double residual = next - base - (k.halfT * slope);
+                            next -= residual / (1.0 - (k.halfT * slopeDerivative));
+                        }
+                    }
+
+                    // A non-finite step restarts the lane from demagnetised tape,
+                    // field history included. Non-finite input is passed on
+                    // rather than turned into silence, so ProcessBlock catches
+                    // the stage that produced it. A hot field can throw an
+                    // explicit step past saturation, from where the loop never
+                    // finds its way back, so M is held within +-Ms.
+                    const bool finite = std::isfinite(next);
+                    M[lane] = finite ? std::clamp(next, -k.Ms, k.Ms) : 0.0;
+                    Hprev[lane] = finite ? H : 0.0;
+                    dHprev[lane] = finite ? dH : 0.0;
+
+                    io[static_cast<size_t>(lane)][i] = std::isfinite(H) ? M[lane] * k.outputScale : H;
+                }
+            }
+
+            magnetisation = M;
+            field = Hprev;
+            fieldDerivative = dHprev;
+        }
+
+        Constants constants;
+        HysteresisSolver solver = HysteresisSolver::rk2;
+        int newtonIterations = 4;
+
+        double cookedBias = -1.0, cookedSampleRate = 0.0;
+
+        LaneArray magnetisation {}, field {}, fieldDerivative {};
+    };
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "SignalGuard.h"
+#include <array>
+#include <cmath>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // MULTI-RATE COMPANDER
+    // ==============================================================================
+    //
+    // Block-wise alternative to CompanderBand. The high band that is added back to
+    // the signal is still formed at audio rate, but the level detection, the
+    // log companding curve and the compGain smoothing run once every
+    // `decimation` samples on the mean detected level, and the resulting gain is
+    // ramped linearly back at audio rate. The curve comes from a table.
+
+    enum class CompanderMode
+    {
+        perSample,
+        multiRate
+    };
+
+    // absHigh / (log(1 + 255 * absHigh) / log(256)) over the clipped detector range [0, 1]
+    class CompanderCurveTable
+    {
+    public:
+
+        static constexpr int size = 1024;
+
+        CompanderCurveTable() noexcept
+        {
+            for (int i = 0; i <= size; ++i)
+                table[static_cast<size_t>(i)] = evaluate(static_cast<double>(i) / size);
+
+            table[size + 1] = table[size];
+        }
+
+        static double evaluate(double absHigh) noexcept
+        {
+            if (absHigh <= 0.0)
+                return 2.40823996531 / 255.0;
+
+            return absHigh / (std::log(1.0 + (255.0 * absHigh)) / 2.40823996531);
+        }
+
+        double operator()(double absHigh) const noexcept
+        {
+            // Written so a NaN level lands on the first entry instead of reading
+            // outside the table
+            const double position = (absHigh >= 0.0 ? std::min(absHigh, 1.0) : 0.0) * size;
+            const int index = static_cast<int>(position);
+            const double frac = position - index;
+            return table[static_cast<size_t>(index)] + (frac * (table[static_cast<size_t>(index) + 1] - table[static_cast<size_t>(index)]));
+        }
+
+        // Built on first use; ProcessBlock::prepareDSP touches it off the audio thread
+        static const CompanderCurveTable& get() noexcept
+        {
+            static const CompanderCurveTable instance;
+            return instance;
+        }
+
+    private:
+
+        std::array<double, size + 2> table {};
+    };
+
+    // One compander stage (encode or decode) for both channels, as two lanes
+    class MultiRateCompander
+    {
+    public:
+
+        static constexpr int lanes = 2;
+
+        explicit MultiRateCompander(bool decode) noexcept : isDecode(decode) {}
+
+        void reset() noexcept
+        {
+            iirFilter.fill(0.0);
+            avgLevel.fill(0.0);
+            levelSum.fill(0.0);
+            compGain.fill(1.0);
+            gain.fill(1.0);
+            gainStep.fill(0.0);
+            counter = 0;
+        }
+
+        bool isFinite() const noexcept
+        {
+            return allFiniteIn(iirFilter) && allFiniteIn(avgLevel) && allFiniteIn(levelSum)
+                && allFiniteIn(compGain) && allFiniteIn(gain) && allFiniteIn(gainStep);
+        }
+
+        void setDecimation(int newDecimation) noexcept
+        {
+            decimation = newDecimation < 1 ? 1 : newDecimation;
+            counter = 0;
+            levelSum.fill(0.0);
+        }
+
+        int getDecimation() const noexcept { return decimation; }
+
+        // Filter, level detector and applied gain of one lane, to hand the stage
+        // over to or from a pair of per-sample CompanderBands
+        struct LaneState
+        {
+            double iirFilter = 0.0, avgLevel = 0.0, gain = 1.0;
+        };
+
+        LaneState getLaneState(size_t lane) const noexcept
+        {
+            return { iirFilter[lane], avgLevel[lane], gain[lane] };
+        }
+
+        // Takes over both lanes, holding their gains until a fresh window ends
+        void setLaneStates(const LaneState& left, const LaneState& right) noexcept
+        {
+            const std::array<LaneState, lanes> states { left, right };
+
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                iirFilter[lane] = states[lane].iirFilter;
+                avgLevel[lane] = states[lane].avgLevel;
+                compGain[lane] = gain[lane] = states[lane].gain;
+            }
+
+            gainStep.fill(0.0);
+            levelSum.fill(0.0);
+            counter = 0;
+        }
+
+        void process(double* left, double* right, int numSamples, double amount, double freq) noexcept
+        {
+            const auto& curve = CompanderCurveTable::get();
+
+            const double factor = isDecode ? 2.628 : 2.848;
+            const double avgFactor = isDecode ? 1.372 : 1.152;
+
+            // One-pole coefficient of the per-sample smoother, applied once per decimated step
+            const double controlFreq = 1.0 - std::pow(1.0 - freq, static_cast<double>(decimation));
+            const double inverseDecimation = 1.0 / decimation;
+
+            std::array<double*, lanes> channels { left, right };
+            std::array<double, lanes> highPart {};
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // Audio-rate high band and level detection
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    const double sample = channels[lane][i];
+
+                    iirFilter[lane] = (iirFilter[lane] * (1.0 - freq)) + (sample * freq);
+
+                    const double high = sample - iirFilter[lane];
+                    const double part = (high * factor) + avgLevel[lane];
+                    avgLevel[lane] = high * avgFactor;
+
+                    highPart[lane] = part > 1.0 ? 1.0 : (part < -1.0 ? -1.0 : part);
+                    levelSum[lane] += std::abs(highPart[lane]);
+                }
+
+                // Control rate: curve and compGain smoothing on the mean level of
+                // the window that ends here, then ramp towards it over the next one
+                if (++counter >= decimation)
+                {
+                    counter = 0;
+
+                    for (size_t lane = 0; lane < lanes; ++lane)
+                    {
+                        const double target = curve(levelSum[lane] * inverseDecimation);
+                        levelSum[lane] = 0.0;
+
+                        compGain[lane] = (compGain[lane] * (1.0 - controlFreq)) + (target * controlFreq);
+                        gainStep[lane] = (compGain[lane] - gain[lane]) * inverseDecimation;
+                    }
+                }
+
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    gain[lane] += gainStep[lane];
+                    channels[lane][i] += (highPart[lane] * gain[lane]) * amount;
+                }
+            }
+        }
+
+    private:
+
+        bool isDecode = false;
+        int decimation = 8;
+        int counter = 0;
+
+        std::array<double, lanes> iirFilter {};
+        std::array<double, lanes> avgLevel {};
+        std::array<double, lanes> levelSum {};
+        std::array<double, lanes> compGain { 1.0, 1.0 };
+        std::array<double, lanes> gain { 1.0, 1.0 };
+        std::array<double, lanes> gainStep {};
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include <cstdint>
+
+namespace MarsDSP::DSP
+{
+    // Counter-based random source for the tape engine. Value i of a stream is a
+    // hash of (i, key), so a block of any length is filled by independent lanes
+    // with no serial dependency between them, and the fill loops vectorise. A
+    // serial generator such as XORShift has to step once per value.
+    //
+    // The hash is Wellons' lowbias32, a two-multiply integer finaliser with
+    // very low bias, which is plenty for noise and dither. Streams with
+    // different keys are the same sequence visited in a different order.
+    class NoiseGenerator
+    {
+    public:
+
+        NoiseGenerator() = default;
+        ~NoiseGenerator() = default;
+
+        void seed(std::uint32_t newSeed) noexcept
+        {
+            key = hash(newSeed);
+            counter = 0;
+        }
+
+        // Uniform in [0, 1), 24 bits
+        void fillUniform(float* destination, int numValues) noexcept
+        {
+            const std::uint32_t base = counter;
+
+            for (int i = 0; i < numValues; ++i)
+                destination[i] = uniform(at(base + static_cast<std::uint32_t>(i)));
+
+            counter += static_cast<std::uint32_t>(numValues);
+        }
+
+        // Zero mean, unit variance, triangular between -sqrt(6) and sqrt(6):
+        // the sum of the two 16-bit halves of one hash. Filtered, as in the
+        // hiss stage, it is indistinguishable from Gaussian noise.
+        void fillNoise(float* destination, int numValues) noexcept
+        {
+            const std::uint32_t base = counter;
+
+            for (int i = 0; i < numValues; ++i)
+                destination[i] = triangular(at(base + static_cast<std::uint32_t>(i)));
+
+            counter += static_cast<std::uint32_t>(numValues);
+        }
+
+        // Stereo fills take frames in turn, left then right, so the values a
+        // channel gets do not depend on how the stream is split into blocks
+        void fillUniform(float* left, float* right, int numFrames) noexcept
+        {
+            const std::uint32_t base = counter;
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const std::uint32_t index = base + (2u * static_cast<std::uint32_t>(i));
+                left[i] = uniform(at(index));
+                right[i] = uniform(at(index + 1u));
+            }
+
+            counter += 2u * static_cast<std::uint32_t>(numFrames);
+        }
+
+        void fillNoise(float* left, float* right, int numFrames) noexcept
+        {
+            const std::uint32_t base = counter;
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const std::uint32_t index = base + (2u * static_cast<std::uint32_t>(i));
+                left[i] = triangular(at(index));
+                right[i] = triangular(at(index + 1u));
+            }
+
+            counter += 2u * static_cast<std::uint32_t>(numFrames);
+        }
+
+        static constexpr std::uint32_t hash(std::uint32_t x) noexcept
+        {
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+    private:
+
+        std::uint32_t at(std::uint32_t index) const noexcept { return hash(index ^ key); }
+
+        static float uniform(std::uint32_t h) noexcept
+        {
+            return static_cast<float>(h >> 8) * 0x1.0p-24f;
+        }
+
+        static float triangular(std::uint32_t h) noexcept
+        {
+            constexpr float scale = 2.449489743f * 0x1.0p-16f;
+            return static_cast<float>(static_cast<std::int32_t>(h & 0xffffu) + static_cast<std::int32_t>(h >> 16) - 0xffff) * scale;
+        }
+
+        std::uint32_t key = hash(0xDEADBEEF);
+        std::uint32_t counter = 0;
+    };
+}
@@ -1,36 +1,133 @@
 #pragma once
 
-#include <Includes.h>
-#include "Parameters.h"
+#include <DSPIncludes.h>
 #include "Smoother.h"
+#include "BackgroundWorker.h"
 #include "TapeDSP.h"
+#include "AnalysisTap.h"
+#include "QualityGovernor.h"
+#include "SignalGuard.h"
+#include "SnapshotMorph.h"
+#include <mutex>
 
 namespace MarsDSP::DSP {
 
+    // ParametersType is MarsDSP::Parameters inside the plugin and
+    // MarsDSP::ParameterValues for the headless ToBIAS_DSP library.
+    template <typename ParametersType>
     class ProcessBlock
     {
     public:
 
+        // Parameter/coefficient update period, in samples
+        static constexpr int controlBlockSize = 32;
+
+        // Upper bound of the "generations" parameter
+        static constexpr int maxGenerations = 8;
+
+        // Only the first generation is built up front; the others, and their
+        // flutter delay capacity in the arena, come with reserveGenerations
         ProcessBlock() = default;
         ~ProcessBlock() = default;
 
-        void prepareDSP (double sampleRate, juce::uint32 samplesPerBlock, juce::uint32 numChannels, const Parameters& params)
+        // The first call builds everything. Later calls with the same
+        // parameters re-prepare: nothing is allocated or cleared, and the new
+        // sample rate is handed to the audio thread, which rescales the running
+        // state at the start of its next block (see applySampleRate). Nothing
+        // here depends on the host block size, as the engine only ever sees
+        // control blocks, so a new samplesPerBlock needs no work at all.
+        void prepareDSP (double sampleRate, juce::uint32 samplesPerBlock, juce::uint32 numChannels, const ParametersType& params)
         {
             spec.sampleRate = sampleRate;
             spec.maximumBlockSize = samplesPerBlock;
             spec.numChannels = numChannels;
 
-            smoother = std::make_unique<Smoother<Parameters>>(params);
+            preparedSampleRate.store(sampleRate, std::memory_order_release);
+
+            if (smoother != nullptr && smoother->isReading(params))
+            {
+                pendingSampleRate.store(sampleRate, std::memory_order_release);
+                reserveGenerations(params.get(Param::generations));
+                return;
+            }
+
+            smoother = std::make_unique<Smoother<ParametersType>>(params);
+            parameters = &params;
+
+            // Build the shared lookup tables here rather than on the audio thread
+            juce::ignoreUnused(CompanderCurveTable::get());
+            juce::ignoreUnused(ModulationWavetables::get());
+            juce::ignoreUnused(SaturationTables::get());
+
+            reset();
+            reserveGenerations(params.get(Param::generations));
+        }
+
+        // Off the audio thread (message or worker thread). Builds and prepares
+        // the engines for up to count generations, each registered with the
+        // flutter delay arena, so the audio thread can raise the parameter to
+        // count without allocating; it runs no more generations than this.
+        // Engines are kept once built, so an instance never holds more than
+        // the most generations it has been asked for.
+        void reserveGenerations(int count)
+        {
+            count = juce::jlimit(1, maxGenerations, count);
+
+            const std::lock_guard<std::mutex> lock(reserveMutex);
+            const int reserved = reservedGenerations.load(std::memory_order_relaxed);
+
+            if (count <= reserved)
+                return;
+
+            juce::dsp::ProcessSpec engineSpec { preparedSampleRate.load(std::memory_order_acquire), 0, 2 };
+
+            for (int g = reserved; g < count; ++g)
+            {
+                auto engine = std::make_unique<TapeDSP>();
+                engine->setCompanderDecimation(companderDecimation);
+                engine->setSaturationMode(saturationMode);
+                engine->prepare(engineSpec);
+                bounces[static_cast<size_t>(g - 1)] = std::move(engine);
+            }
+
+            reservedGenerations.store(count, std::memory_order_release);
+        }
+
+        // Clears all tape state and snaps the smoothers onto the current
+        // parameters, at the rate of the last prepareDSP. Not to be called
+        // while the audio thread is processing.
+        void reset()
+        {
+            pendingSampleRate.store(0.0, std::memory_order_relaxed);
+            engineSampleRate = spec.sampleRate;
+
             smoother->prepare(spec);
             smoother->reset();
 
-            tape.prepare(spec);
-            
-            if (m_scratchBuffer.size() < spec.maximumBlockSize)
-                m_scratchBuffer.resize(spec.maximumBlockSize);
+            {
+                const std::lock_guard<std::mutex> lock(reserveMutex);
+
+                for (int g = 0; g < getReservedGenerations(); ++g)
+                {
+                    generation(g).prepare(spec);
+                    generation(g).setQualityLevel(0);
+                }
+            }
+
+            activeGenerations = 1;
+            governor.prepare(engineSampleRate);
+            qualityLevel = 0;
+            guard.prepare(engineSampleRate);
+            snapshotMorph.reset();
+            samplesUntilControlUpdate = 0;
         }
 
-        void process (juce::AudioBuffer<float>& buffer)
+        // Host buffers of any size are cut onto a fixed control grid: parameters
+        // and coefficients are refreshed every controlBlockSize samples of stream
+        // time, independent of how the host splits its callbacks, and TapeDSP
+        // never sees more than one control block at once. No latency is added.
+        template <typename SampleType>
+        void process (juce::AudioBuffer<SampleType>& buffer)
         {
             const auto numChannels = buffer.getNumChannels();
             const auto numSamples = buffer.getNumSamples();
@@ -38,42 +135,396 @@ namespace MarsDSP::DSP {
             if (numChannels == 0 || numSamples == 0)
                 return;
 
+            if (pendingSampleRate.load(std::memory_order_relaxed) > 0.0)
+                applySampleRate(pendingSampleRate.exchange(0.0, std::memory_order_acquire));
+
             if (smoother)
                 smoother->update();
 
-            if (smoother && smoother->getBypass())
+            if (smoother && smoother->get(Param::bypass))
                 return;
 
-            const float* inL = buffer.getReadPointer(0);
-            float* outL = buffer.getWritePointer(0);
-            const float* inR = nullptr;
-            float* outR = nullptr;
+            // Only timed while the governor is on
+            const bool governed = smoother && smoother->get(Param::adaptiveQuality);
+            const auto startTicks = governed ? juce::Time::getHighResolutionTicks() : juce::int64 {};
 
-            if (numChannels > 1)
+            // Input the engine cannot survive never reaches it
+            const int numProcessed = std::min(numChannels, 2);
+
+            for (int ch = 0; ch < numProcessed; ++ch)
             {
-                inR = buffer.getReadPointer(1);
-                outR = buffer.getWritePointer(1);
+                if (! SignalGuard::isSafe(buffer.getReadPointer(ch), numSamples))
+                {
+                    for (int c = 0; c < numProcessed; ++c)
+                        buffer.clear(c, 0, numSamples);
+
+                    guard.noteInputFault();
+                    break;
+                }
             }
 
-            else
+            const SampleType* inL = buffer.getReadPointer(0);
+            SampleType* outL = buffer.getWritePointer(0);
+            const SampleType* inR = numChannels > 1 ? buffer.getReadPointer(1) : nullptr;
+            SampleType* outR = numChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+
+            // Mono runs the right channel on the left input into a scratch block
+            SampleType* scratch = getScratchBuffer<SampleType>().data();
+
+            // Left input of the current stretch, kept for the analysis tap
+            // since the generations overwrite it in place
+            const bool tapping = analysis.beginBlock(engineSampleRate);
+            alignas(64) std::array<SampleType, controlBlockSize> tapInput;
+
+            int processed = 0;
+
+            while (processed < numSamples)
             {
-                inR = inL;
+                if (samplesUntilControlUpdate == 0)
+                {
+                    // Parameters are read once and shared by every generation
+                    TapeDSP::readControls(*smoother, controlBlockSize, controls);
+                    setQualityLevel(governor.getLevel());
+
+                    const bool morphing = snapshotMorph.update();
+
+                    // Generations cannot be blended, so a change waits for the
+                    // end of a morph rather than cutting into it
+                    if (! morphing)
+                        setActiveGenerations(smoother->get(Param::generations));
+
+                    if (morphing)
+                    {
+                        // The smoothers keep running underneath, unused, and are
+                        // snapped onto the target parameters once the morph ends
+                        TapeDSP::CoefficientSet coefficients;
+                        const bool finished = snapshotMorph.next(controlBlockSize, coefficients, controls);
+
+                        for (int g = 0; g < activeGenerations; ++g)
+                            generation(g).applyCoefficients(coefficients, controls, controlBlockSize);
+
+                        if (finished)
+                            smoother->reset();
+                    }
+
+                    else
+                    {
+                        // Once the smoothers have settled on values the worker
+                        // has designed for, its coefficients are installed as
+                        // they are; while they ramp, every block is designed here
+                        coefficientFeed.update();
+                        const auto& precomputed = coefficientFeed.read();
+
+                        if (precomputed.key == PrecomputedCoefficients::keyOf(controls, engineSampleRate))
+                        {
+                            for (int g = 0; g < activeGenerations; ++g)
+                                generation(g).applyCoefficients(precomputed.coefficients, controls, controlBlockSize);
+                        }
+
+                        else
+                        {
+                            for (int g = 0; g < activeGenerations; ++g)
+                                generation(g).applyControls(controls, controlBlockSize);
+                        }
+                    }
 
-                if (m_scratchBuffer.size() < numSamples)
-                    m_scratchBuffer.resize(numSamples);
-                
-                outR = m_scratchBuffer.data();
+                    samplesUntilControlUpdate = controlBlockSize;
+                }
+
+                const int n = std::min(numSamples - processed, samplesUntilControlUpdate);
+
+                if (tapping)
+                    std::copy_n(inL + processed, n, tapInput.data());
+
+                // All generations run over this stretch before the next one is
+                // read, so the audio stays in L1 across every pass. Later
+                // generations work in place on the output of the one before.
+                for (int g = 0; g < activeGenerations; ++g)
+                {
+                    const SampleType* sourceL = g == 0 ? inL + processed : outL + processed;
+
+                    if (outR != nullptr)
+                        generation(g).processSamples(sourceL, g == 0 ? inR + processed : outR + processed,
+                                                     outL + processed, outR + processed, n, controls);
+                    else
+                        generation(g).processSamples(sourceL, g == 0 ? inL + processed : scratch,
+                                                     outL + processed, scratch, n, controls);
+                }
+
+                if (tapping)
+                    analysis.push(tapInput.data(), outL + processed, n, tape.getFlutterOffset());
+
+                processed += n;
+                samplesUntilControlUpdate -= n;
             }
 
-            tape.processTape(inL, inR, outL, outR, numSamples, *smoother);
+            containOutput(outL, outR, numSamples);
+
+            const auto elapsed = governed ? juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) : 0.0;
+            governor.update(elapsed, numSamples, governed);
+        }
+
+        // Multi-rate compander update interval; call while stopped
+        void setCompanderDecimation(int decimation)
+        {
+            const std::lock_guard<std::mutex> lock(reserveMutex);
+            companderDecimation = decimation;
+
+            for (int g = 0; g < getReservedGenerations(); ++g)
+                generation(g).setCompanderDecimation(decimation);
+        }
+
+        // Direct or tabled saturation curves, for comparison; call while stopped
+        void setSaturationMode(SaturationMode mode)
+        {
+            const std::lock_guard<std::mutex> lock(reserveMutex);
+            saturationMode = mode;
+
+            for (int g = 0; g < getReservedGenerations(); ++g)
+                generation(g).setSaturationMode(mode);
+        }
+
+        // Message thread. Glides the sound between two sets of plain parameter
+        // values (one per parameterTable row) over the given time; both ends are
+        // worked out here, so the audio thread only blends them. The caller then
+        // sets the parameters to `to`. Returns false, and the change should just
+        // be applied to the parameters, before prepareDSP or while the handover
+        // is full.
+        bool morphBetween(const std::array<float, numParameters>& from, const std::array<float, numParameters>& to, double seconds)
+        {
+            if (spec.sampleRate <= 0.0)
+                return false;
+
+            MorphRequest request;
+            TapeDSP::ControlValues endpoint;
+
+            TapeDSP::readControls(from, endpoint);
+            TapeDSP::computeCoefficients(endpoint, spec.sampleRate, request.from);
+
+            TapeDSP::readControls(to, endpoint);
+            TapeDSP::computeCoefficients(endpoint, spec.sampleRate, request.to);
+
+            request.antialias = endpoint.antialias;
+            request.hysteresis = endpoint.hysteresis;
+            request.compander = endpoint.compander;
+            request.flutterMode = endpoint.flutterMode;
+            request.lengthSamples = std::max(1, juce::roundToInt(seconds * spec.sampleRate));
+
+            return snapshotMorph.post(request);
+        }
+
+        // Worker thread (see BackgroundWorker). Designs the coefficients of the
+        // current parameter values at the prepared rate, if either changed
+        // since the last call, and publishes them for the audio thread. Does
+        // nothing before prepareDSP.
+        void rebuildCoefficients()
+        {
+            const double sampleRate = preparedSampleRate.load(std::memory_order_acquire);
+
+            if (sampleRate <= 0.0 || parameters == nullptr)
+                return;
+
+            // Read the way the smoothers read them, so settled values match exactly
+            std::array<float, numParameters> values {};
+            forEachParameter([this, &values](auto tag)
+            {
+                values[decltype(tag)::index] = static_cast<float>(parameters->get(tag));
+            });
+
+            reserveGenerations(juce::roundToInt(values[Param::generations.index]));
+
+            TapeDSP::ControlValues targets;
+            TapeDSP::readControls(values, targets);
+            const auto key = PrecomputedCoefficients::keyOf(targets, sampleRate);
+
+            if (key == lastRebuilt)
+                return;
+
+            auto& slot = coefficientFeed.beginWrite();
+            slot.key = key;
+            TapeDSP::computeCoefficients(targets, sampleRate, slot.coefficients);
+            coefficientFeed.publish();
+
+            lastRebuilt = key;
         }
 
+        int getActiveGenerations() const noexcept { return activeGenerations; }
+
+        // Generations built so far (see reserveGenerations); any thread
+        int getReservedGenerations() const noexcept { return reservedGenerations.load(std::memory_order_acquire); }
+
+        // Level QualityGovernor has settled on, 0 being full quality; any thread
+        int getQualityLevel() const noexcept { return governor.getReportedLevel(); }
+
+        // Input/output envelopes and flutter pitch for an editor; inactive
+        // until its consumer calls start()
+        AnalysisTap& getAnalysisTap() noexcept { return analysis; }
+
+        // Blocks silenced for bad output, and for bad input, since prepareDSP
+        int getNumFaults() const noexcept { return guard.getNumFaults(); }
+        int getNumInputFaults() const noexcept { return guard.getNumInputFaults(); }
+
+        // TapeDSP::StatePart bits the last bad output block had reset, over
+        // every generation; audio thread, for analysis
+        uint32_t getRecoveredState() const noexcept { return recoveredState; }
+
+        // For containment tests: see TapeDSP::poisonState. Audio thread or
+        // while stopped.
+        void poisonState(TapeDSP::StatePart part) noexcept { tape.poisonState(part); }
+
     private:
 
+        // Coefficients for one set of continuous control values at one rate
+        struct PrecomputedCoefficients
+        {
+            using Key = std::array<double, 15>;
+
+            Key key {};
+            TapeDSP::CoefficientSet coefficients;
+
+            static Key keyOf(const TapeDSP::ControlValues& c, double sampleRate) noexcept
+            {
+                return { c.input, c.output, c.tilt, c.shape, c.flutter, c.flutterSpeed, c.bumpHead, c.bumpHz, c.bias, c.hiss,
+                         c.wow, c.capstan, c.scrape, c.correlation, sampleRate };
+            }
+        };
+
+        TapeDSP& generation(int index) noexcept
+        {
+            return index == 0 ? tape : *bounces[static_cast<size_t>(index - 1)];
+        }
+
+        // Audio thread, for a re-prepare: moves every part that depends on the
+        // rate onto the new one and keeps its state. The next block starts a
+        // fresh control block, so coefficients are redesigned before any
+        // sample is processed. A running snapshot morph is dropped, as both
+        // of its ends were worked out for the old rate; the smoothers take
+        // over from there.
+        void applySampleRate(double newSampleRate) noexcept
+        {
+            if (newSampleRate <= 0.0 || newSampleRate == engineSampleRate)
+                return;
+
+            smoother->changeSampleRate(engineSampleRate, newSampleRate);
+
+            for (int g = 0; g < getReservedGenerations(); ++g)
+                generation(g).changeSampleRate(newSampleRate);
+
+            governor.changeSampleRate(newSampleRate);
+            guard.changeSampleRate(engineSampleRate, newSampleRate);
+            snapshotMorph.reset();
+
+            engineSampleRate = newSampleRate;
+            samplesUntilControlUpdate = 0;
+        }
+
+        // A non-finite or runaway output block is replaced with silence, the
+        // state that caused it is reset, and the next blocks fade back in
+        template <typename SampleType>
+        void containOutput(SampleType* outL, SampleType* outR, int numSamples) noexcept
+        {
+            if (SignalGuard::isSafe(outL, numSamples) && (outR == nullptr || SignalGuard::isSafe(outR, numSamples)))
+            {
+                if (guard.isFadingIn())
+                    guard.applyFadeIn(outL, outR, numSamples);
+
+                return;
+            }
+
+            // Idle generations are included, so one that joins later is clean too
+            recoveredState = 0;
+
+            for (int g = 0; g < getReservedGenerations(); ++g)
+                recoveredState |= generation(g).recoverNonFinite();
+
+            std::fill_n(outL, numSamples, SampleType(0));
+
+            if (outR != nullptr)
+                std::fill_n(outR, numSamples, SampleType(0));
+
+            guard.noteOutputFault();
+        }
+
+        // Applied to every built generation so ones that join later match;
+        // one built since is brought up to date as it joins
+        void setQualityLevel(int level) noexcept
+        {
+            if (level == qualityLevel)
+                return;
+
+            for (int g = 0; g < getReservedGenerations(); ++g)
+                generation(g).setQualityLevel(level);
+
+            qualityLevel = level;
+        }
+
+        // Generations that join start from fresh tape rather than whatever
+        // they held when they last ran, at the engine's rate and quality level.
+        // No more run than have been reserved.
+        void setActiveGenerations(int requested) noexcept
+        {
+            requested = juce::jlimit(1, getReservedGenerations(), requested);
+
+            for (int g = activeGenerations; g < requested; ++g)
+            {
+                auto& engine = generation(g);
+
+                if (engine.getSampleRate() != engineSampleRate)
+                    engine.changeSampleRate(engineSampleRate);
+
+                engine.setQualityLevel(qualityLevel);
+                engine.reset();
+            }
+
+            activeGenerations = requested;
+        }
+
+        template <typename SampleType>
+        std::array<SampleType, controlBlockSize>& getScratchBuffer() noexcept
+        {
+            if constexpr (std::is_same_v<SampleType, double>)
+                return m_scratchBufferDouble;
+            else
+                return m_scratchBuffer;
+        }
+
         juce::dsp::ProcessSpec spec {};
         std::unique_ptr<juce::dsp::Oversampling<float>> m_oversample;
-        std::unique_ptr<Smoother<Parameters>> smoother;
+        std::unique_ptr<Smoother<ParametersType>> smoother;
         TapeDSP tape;
-        std::vector<float> m_scratchBuffer;
+        TapeDSP::ControlValues controls;
+        int activeGenerations { 1 };
+
+        // Generations after the first, built by reserveGenerations; the
+        // audio thread only touches the first reservedGenerations - 1
+        std::array<std::unique_ptr<TapeDSP>, maxGenerations - 1> bounces;
+        std::atomic<int> reservedGenerations { 1 };
+        std::mutex reserveMutex;
+        int companderDecimation { 8 };
+        SaturationMode saturationMode { SaturationMode::table };
+
+        // One control block is the most TapeDSP is ever handed at once
+        alignas(64) std::array<float, controlBlockSize> m_scratchBuffer {};
+        alignas(64) std::array<double, controlBlockSize> m_scratchBufferDouble {};
+
+        int samplesUntilControlUpdate { 0 };
+        AnalysisTap analysis;
+        QualityGovernor governor;
+        int qualityLevel { 0 };
+        SignalGuard guard;
+        uint32_t recoveredState { 0 };
+        SnapshotMorph snapshotMorph;
+
+        // Rate the engine runs at, audio thread side, and a re-prepare's new
+        // rate waiting for it (0 when none is)
+        double engineSampleRate { 0.0 };
+        std::atomic<double> pendingSampleRate { 0.0 };
+
+        // Worker side: the rate of the last prepareDSP, the parameters it was
+        // given, and what was published last
+        std::atomic<double> preparedSampleRate { 0.0 };
+        const ParametersType* parameters { nullptr };
+        typename PrecomputedCoefficients::Key lastRebuilt {};
+        Published<PrecomputedCoefficients> coefficientFeed;
     };
 }
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "ADAA.h"
+
+namespace MarsDSP::DSP
+{
+    // What each quality level allows, from full quality down. TapeDSP applies
+    // the caps on top of the user's own choices, so a level never raises
+    // anything the user has turned down.
+    struct QualitySettings
+    {
+        int interpolationPoints;        // flutter delay read: 6 (5th order Lagrange), 4 (cubic) or 2 (linear)
+        AntialiasMode maxAntialias;     // highest ADAA order on the saturation and clip curves
+        bool rk2Only;                   // Jiles-Atherton falls back to its cheapest solver
+        int companderDecimationScale;   // multiplies the multi-rate compander's update interval
+        bool perSampleCompander;        // false hands the per-sample compander over to the
+                                        // multi-rate one, updating every companderDecimationScale
+                                        // samples; kept to the last level, as it costs 28-40 dB SNR
+    };
+
+    inline constexpr std::array qualityLevels
+    {
+        QualitySettings { 6, AntialiasMode::secondOrder, false, 1, true },
+        QualitySettings { 4, AntialiasMode::secondOrder, false, 2, true },
+        QualitySettings { 4, AntialiasMode::firstOrder,  true,  2, true },
+        QualitySettings { 2, AntialiasMode::off,         true,  4, false }
+    };
+
+    inline constexpr int numQualityLevels = static_cast<int>(qualityLevels.size());
+
+    // Watches how much of each host block's real-time budget processing takes
+    // and picks a quality level for the blocks after it. The load estimate
+    // follows peaks at once and decays over about half a second. It steps one
+    // level down when the load stays above stepDownLoad, and one level back up
+    // only after it has stayed below stepUpLoad for a few seconds; the gap
+    // between the two keeps it from hunting. Audio thread only, except for
+    // getReportedLevel().
+    class QualityGovernor
+    {
+    public:
+
+        static constexpr double stepDownLoad = 0.6;
+        static constexpr double stepUpLoad = 0.25;
+
+        QualityGovernor() = default;
+        ~QualityGovernor() = default;
+
+        void prepare(double newSampleRate) noexcept
+        {
+            sampleRate = newSampleRate;
+            reset();
+        }
+
+        // Keeps the level and the load history; the hold and recovery
+        // counters are rescaled so they still run out when they would have
+        void changeSampleRate(double newSampleRate) noexcept
+        {
+            const double ratio = newSampleRate / sampleRate;
+            samplesSinceChange = static_cast<juce::int64>(static_cast<double>(samplesSinceChange) * ratio);
+            samplesUnderLoad = static_cast<juce::int64>(static_cast<double>(samplesUnderLoad) * ratio);
+            sampleRate = newSampleRate;
+        }
+
+        void reset() noexcept
+        {
+            level = 0;
+            load = 0.0;
+            samplesSinceChange = 0;
+            samplesUnderLoad = 0;
+            reportedLevel.store(0, std::memory_order_relaxed);
+        }
+
+        // Feeds the time one host block of numSamples took and returns the
+        // level for the next. Disabled, it goes straight back to full quality.
+        int update(double elapsedSeconds, int numSamples, bool enabled) noexcept
+        {
+            if (! enabled)
+            {
+                if (level != 0)
+                    reset();
+
+                return 0;
+            }
+
+            const double budget = static_cast<double>(numSamples) / sampleRate;
+            const double blockLoad = elapsedSeconds / budget;
+            const double release = std::exp(-static_cast<double>(numSamples) / (loadReleaseSeconds * sampleRate));
+
+            load = blockLoad > load ? blockLoad : blockLoad + ((load - blockLoad) * release);
+
+            samplesSinceChange += numSamples;
+            samplesUnderLoad = load < stepUpLoad ? samplesUnderLoad + numSamples : 0;
+
+            if (load > stepDownLoad && level < numQualityLevels - 1 && samplesSinceChange >= samplesIn(holdSeconds))
+                setLevel(level + 1);
+
+            else if (level > 0 && samplesUnderLoad >= samplesIn(recoverSeconds))
+                setLevel(level - 1);
+
+            return level;
+        }
+
+        int getLevel() const noexcept { return level; }
+
+        // Current level for display, from any thread; 0 is full quality
+        int getReportedLevel() const noexcept { return reportedLevel.load(std::memory_order_relaxed); }
+
+        // Smoothed share of the block budget spent processing
+        double getLoad() const noexcept { return load; }
+
+    private:
+
+        static constexpr double loadReleaseSeconds = 0.5;
+        static constexpr double holdSeconds = 0.25;
+        static constexpr double recoverSeconds = 3.0;
+
+        juce::int64 samplesIn(double duration) const noexcept
+        {
+            return static_cast<juce::int64>(duration * sampleRate);
+        }
+
+        void setLevel(int newLevel) noexcept
+        {
+            level = newLevel;
+            samplesSinceChange = 0;
+            samplesUnderLoad = 0;
+            reportedLevel.store(level, std::memory_order_relaxed);
+        }
+
+        double sampleRate = 48000.0;
+        double load = 0.0;
+        int level = 0;
+        juce::int64 samplesSinceChange = 0, samplesUnderLoad = 0;
+        std::atomic<int> reportedLevel { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(QualityGovernor)
+    };
+}
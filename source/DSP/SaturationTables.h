@@ -0,0 +1,157 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // SATURATION TABLES
+    // ==============================================================================
+    //
+    // The memoryless curves of TapeDSP's split-band saturation, baked into
+    // piecewise cubic tables so a sub-block of lows or highs is shaped in
+    // branch-free loops with no sin or cos calls: an index computation, four
+    // coefficient loads (gathers once vectorised) and three multiply-adds per
+    // sample.
+    //
+    // Each segment is the cubic Hermite interpolant of the curve from its
+    // values and slopes at both ends, so the tables are C1 and exact at every
+    // knot. Its error is at most h^4 / 384 * max|f''''| for knot spacing h:
+    //
+    //   sine lows     h = 1.570796 / 64, max|f''''| = 1             < 9.5e-10
+    //   1 - cos thin  h = 1 / 64,        max|f''''| = 1.570796^4   < 9.5e-10
+    //
+    // both under -180 dBFS and far below the output's float resolution, which
+    // SaturationBench checks against the direct curves.
+    //
+    // The curves have no parameters (shape and bias act on the crossover and
+    // the hysteresis around them), so the tables are built once, off the audio
+    // thread, and shared by every engine.
+
+    enum class SaturationMode
+    {
+        direct,
+        table
+    };
+
+    // Odd curve f over [0, range], constant beyond it, as a table of cubic
+    // segments. Curve provides range, value(a) and slope(a) for a in [0, range].
+    template <typename Curve>
+    class OddCurveTable
+    {
+    public:
+
+        static constexpr int size = 64;
+        static constexpr double range = Curve::range;
+
+        OddCurveTable() noexcept
+        {
+            const double step = range / size;
+
+            for (size_t i = 0; i < static_cast<size_t>(size); ++i)
+            {
+                const double y0 = Curve::value(static_cast<double>(i) * step), y1 = Curve::value(static_cast<double>(i + 1) * step);
+                const double m0 = Curve::slope(static_cast<double>(i) * step) * step, m1 = Curve::slope(static_cast<double>(i + 1) * step) * step;
+
+                // Hermite basis expanded into powers of t
+                c0[i] = y0;
+                c1[i] = m0;
+                c2[i] = (3.0 * (y1 - y0)) - (2.0 * m0) - m1;
+                c3[i] = (2.0 * (y0 - y1)) + m0 + m1;
+            }
+
+            // Everything at or past the range lands on a constant last segment
+            c0[size] = Curve::value(range);
+        }
+
+        // values[i] = combine(values[i], f(values[i])). Positions are worked
+        // out in a loop of their own, so both loops vectorise, the second into
+        // gathers where the target has them. A NaN lands on the last segment
+        // instead of reading outside the table.
+        template <typename Combine>
+        void process(double* values, int numValues, Combine&& combine) const noexcept
+        {
+            alignas(64) std::array<double, chunkSize> positions;
+
+            for (int start = 0; start < numValues; start += chunkSize)
+            {
+                double* chunk = values + start;
+                const int count = std::min(chunkSize, numValues - start);
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const double position = std::abs(chunk[i]) * (size / range);
+                    positions[static_cast<size_t>(i)] = position < size ? position : size;
+                }
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const double position = positions[static_cast<size_t>(i)];
+                    const auto index = static_cast<std::int64_t>(position);
+                    const double t = position - static_cast<double>(index);
+                    const auto k = static_cast<size_t>(index);
+                    const double magnitude = c0[k] + (t * (c1[k] + (t * (c2[k] + (t * c3[k])))));
+                    chunk[i] = combine(chunk[i], std::copysign(magnitude, chunk[i]));
+                }
+            }
+        }
+
+    private:
+
+        static constexpr int chunkSize = 64;
+
+        // Coefficients of t^0..t^3 per segment, one array each for the gathers
+        alignas(64) std::array<double, size + 1> c0 {};
+        alignas(64) std::array<double, size + 1> c1 {};
+        alignas(64) std::array<double, size + 1> c2 {};
+        alignas(64) std::array<double, size + 1> c3 {};
+    };
+
+    // Lows: sin(x), clamped at the same +-1.570796 as the direct path
+    struct SineLowsCurve
+    {
+        static constexpr double range = 1.570796;
+
+        static double value(double a) noexcept { return std::sin(a); }
+        static double slope(double a) noexcept { return std::cos(a); }
+    };
+
+    // Highs: the amount 1 - cos(|h| * 1.570796) taken off, saturating at |h| = 1
+    struct CosineThinCurve
+    {
+        static constexpr double range = 1.0;
+
+        static double value(double a) noexcept { return 1.0 - std::cos(a * 1.570796); }
+        static double slope(double a) noexcept { return 1.570796 * std::sin(a * 1.570796); }
+    };
+
+    class SaturationTables
+    {
+    public:
+
+        // Lows in place
+        void shapeLows(double* lows, int numSamples) const noexcept
+        {
+            sine.process(lows, numSamples, [](double, double f) { return f; });
+        }
+
+        // Highs in place
+        void thinHighs(double* highs, int numSamples) const noexcept
+        {
+            thin.process(highs, numSamples, [](double h, double f) { return h - f; });
+        }
+
+        // Built on first use; ProcessBlock::prepareDSP touches it off the audio thread
+        static const SaturationTables& get() noexcept
+        {
+            static const SaturationTables instance;
+            return instance;
+        }
+
+        OddCurveTable<SineLowsCurve> sine;
+        OddCurveTable<CosineThinCurve> thin;
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <DSPIncludes.h>
+
+namespace MarsDSP::DSP
+{
+    // True if every argument is finite; for the state checks in recovery code
+    template <typename... Values>
+    bool allFinite(Values... values) noexcept
+    {
+        return (std::isfinite(values) && ...);
+    }
+
+    template <typename Container>
+    bool allFiniteIn(const Container& values) noexcept
+    {
+        return std::all_of(std::begin(values), std::end(values), [](double v) { return std::isfinite(v); });
+    }
+
+    // Per-block protection for ProcessBlock against NaN, Inf and runaway values.
+    //
+    // A block is checked with a single branch-free reduction, an OR over
+    // !(|x| <= limit), which vectorises and catches NaN, Inf and extreme
+    // samples with the one comparison. Only a block that fails takes the slow
+    // path: the block is silenced and the output fades back in, after the
+    // engine's state has been repaired if the fault came out of it. Bad input
+    // is silenced rather than clamped, since even clamped garbage would be
+    // remembered by the hysteresis model.
+    class SignalGuard
+    {
+    public:
+
+        // About 36 dB over full scale; nothing legitimate gets near it, and
+        // the recursive stages stay well behaved below it
+        static constexpr double limit = 64.0;
+
+        static constexpr double fadeInSeconds = 0.01;
+
+        SignalGuard() = default;
+        ~SignalGuard() = default;
+
+        void prepare(double sampleRate) noexcept
+        {
+            fadeLength = std::max(1, static_cast<int>(sampleRate * fadeInSeconds));
+            fadeRemaining = 0;
+        }
+
+        // A fade in progress keeps its length in time
+        void changeSampleRate(double previousSampleRate, double newSampleRate) noexcept
+        {
+            const double ratio = newSampleRate / previousSampleRate;
+            fadeLength = std::max(1, static_cast<int>(newSampleRate * fadeInSeconds));
+            fadeRemaining = std::min(fadeLength, static_cast<int>(std::lround(fadeRemaining * ratio)));
+        }
+
+        template <typename SampleType>
+        static bool isSafe(const SampleType* samples, int numSamples) noexcept
+        {
+            const auto bound = static_cast<SampleType>(limit);
+            int unsafe = 0;
+
+            // Every comparison with NaN is false, so it fails like Inf does
+            for (int i = 0; i < numSamples; ++i)
+                unsafe |= static_cast<int>(! (std::abs(samples[i]) <= bound));
+
+            return unsafe == 0;
+        }
+
+        // The current block has been silenced, its input or its output; the
+        // output over the next fadeInSeconds ramps back in
+        void noteInputFault() noexcept
+        {
+            fadeRemaining = fadeLength;
+            ++numInputFaults;
+        }
+
+        void noteOutputFault() noexcept
+        {
+            fadeRemaining = fadeLength;
+            ++numFaults;
+        }
+
+        bool isFadingIn() const noexcept { return fadeRemaining > 0; }
+
+        template <typename SampleType>
+        void applyFadeIn(SampleType* left, SampleType* right, int numSamples) noexcept
+        {
+            const int start = fadeLength - fadeRemaining;
+            const int n = std::min(numSamples, fadeRemaining);
+            const auto scale = SampleType(1) / static_cast<SampleType>(fadeLength);
+
+            for (int i = 0; i < n; ++i)
+            {
+                const auto gain = static_cast<SampleType>(start + i) * scale;
+                left[i] *= gain;
+
+                if (right != nullptr)
+                    right[i] *= gain;
+            }
+
+            fadeRemaining -= n;
+        }
+
+        int getNumFaults() const noexcept { return numFaults; }
+        int getNumInputFaults() const noexcept { return numInputFaults; }
+
+    private:
+
+        int fadeLength = 1, fadeRemaining = 0;
+        int numFaults = 0, numInputFaults = 0;
+    };
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "TapeDSP.h"
+
+namespace MarsDSP::DSP
+{
+    // Both ends of a morph, worked out on the message thread
+    struct MorphRequest
+    {
+        TapeDSP::CoefficientSet from, to;
+        int antialias = 0, hysteresis = 0, compander = 0, flutterMode = 0;
+        int lengthSamples = 1;
+    };
+
+    // Glides the tape chain from one set of settings to another without the
+    // smoothers: the coefficient sets of both ends arrive precomputed through
+    // a wait-free FIFO, and the audio thread only blends them, once per
+    // control block, with the input, output and bias ramps blended per
+    // sample. No filter is designed and no pow or tan is evaluated on the
+    // audio thread while a morph runs.
+    //
+    // A request that arrives mid-morph starts from wherever the running one
+    // had got to, so interrupted morphs do not jump. Choice settings switch
+    // to the target's at the start.
+    class SnapshotMorph
+    {
+    public:
+
+        static constexpr int capacity = 4;
+
+        SnapshotMorph() = default;
+        ~SnapshotMorph() = default;
+
+        //==============================================================================
+        // Message thread
+
+        // False if the FIFO is full, which takes several requests within one
+        // audio block; the caller may simply set the parameters instead
+        bool post(const MorphRequest& request) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+            if (size1 == 0)
+                return false;
+
+            requests[static_cast<size_t>(start1)] = request;
+            fifo.finishedWrite(1);
+            return true;
+        }
+
+        //==============================================================================
+        // Audio thread
+
+        // Drops the running morph and anything queued; for prepare, as the sets
+        // were worked out for the old sample rate
+        void reset() noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(capacity, start1, size1, start2, size2);
+            fifo.finishedRead(size1 + size2);
+            position = length = 0;
+        }
+
+        // Takes the newest queued request, if any; true while a morph runs
+        bool update() noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(capacity, start1, size1, start2, size2);
+
+            if (size1 + size2 > 0)
+            {
+                const auto newest = static_cast<size_t>(size2 > 0 ? start2 + size2 - 1 : start1 + size1 - 1);
+                const auto& request = requests[newest];
+
+                from = isActive() ? current : request.from;
+                to = request.to;
+                antialias = request.antialias;
+                hysteresis = request.hysteresis;
+                compander = request.compander;
+                flutterMode = request.flutterMode;
+                length = std::max(1, request.lengthSamples);
+                position = 0;
+
+                fifo.finishedRead(size1 + size2);
+            }
+
+            return isActive();
+        }
+
+        bool isActive() const noexcept { return position < length; }
+
+        // Coefficients and controls for the next control block of numSamples,
+        // numSamples being at most TapeDSP::maxSubBlockSize; returns true when
+        // this block finishes the morph
+        bool next(int numSamples, TapeDSP::CoefficientSet& k, TapeDSP::ControlValues& c) noexcept
+        {
+            const double start = progress(position);
+            current = TapeDSP::CoefficientSet::blend(from, to, start);
+            k = current;
+
+            // Input gain is applied squared, so its ramp is in the square root
+            const double inputFrom = std::sqrt(from.inputGain), inputTo = std::sqrt(to.inputGain);
+            const double step = 1.0 / static_cast<double>(length);
+
+            c.rampLength = numSamples;
+            c.gainsRamping = true;
+
+            // Linear up to the end of the morph, then held at the target
+            const int ramping = std::min(numSamples, length - position);
+
+            for (int i = 0; i < ramping; ++i)
+            {
+                const double t = start + (static_cast<double>(i) * step);
+                const auto index = static_cast<size_t>(i);
+
+                c.inputRamp[index] = static_cast<float>(inputFrom + ((inputTo - inputFrom) * t));
+                c.outputRamp[index] = static_cast<float>(from.outputGain + ((to.outputGain - from.outputGain) * t));
+                c.biasRamp[index] = static_cast<float>(from.bias + ((to.bias - from.bias) * t));
+            }
+
+            for (int i = ramping; i < numSamples; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+
+                c.inputRamp[index] = static_cast<float>(inputTo);
+                c.outputRamp[index] = static_cast<float>(to.outputGain);
+                c.biasRamp[index] = static_cast<float>(to.bias);
+            }
+
+            c.antialias = antialias;
+            c.hysteresis = hysteresis;
+            c.compander = compander;
+            c.flutterMode = flutterMode;
+
+            position = std::min(length, position + numSamples);
+
+            if (isActive())
+                return false;
+
+            current = to;
+            return true;
+        }
+
+    private:
+
+        double progress(int sample) const noexcept
+        {
+            return std::min(1.0, static_cast<double>(sample) / static_cast<double>(length));
+        }
+
+        juce::AbstractFifo fifo { capacity };
+        std::array<MorphRequest, capacity> requests {};
+
+        // Audio-thread state
+        TapeDSP::CoefficientSet from, to, current;
+        int antialias = 0, hysteresis = 0, compander = 0, flutterMode = 0;
+        int position = 0, length = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(SnapshotMorph)
+    };
+}
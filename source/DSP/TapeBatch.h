@@ -0,0 +1,466 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "ParameterValues.h"
+#include "TapeDSP.h"
+#include <algorithm>
+#include <bit>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // BATCHED TAPE ENGINE
+    // ==============================================================================
+    //
+    // Runs Lanes independent tape channels side by side with structure-of-arrays
+    // state, so every stage is a loop over lanes that the compiler can map onto
+    // SIMD registers (4 doubles per AVX register, 8 per AVX-512). Each lane has
+    // its own parameters. Lanes (2k, 2k + 1) form a stereo pair for the scrape
+    // flutter cross-coupling, so a stereo instance occupies two adjacent lanes.
+    //
+    // The chain matches TapeDSP with these differences, chosen to keep the lane
+    // loops branch-free and vectorisable:
+    //   - parameters are applied per process() call, without smoothing
+    //   - the saturation sine/cosine and the compander log use polynomials
+    //     (|error| < 1e-10 over the ranges they see)
+    //   - antialiased curves and the multi-rate compander are not available
+    //   - there is no hiss stage, the hysteresis is always the slew limiter
+    //     stages (no Jiles-Atherton), and each lane is a single generation
+    //   - flutter is always the classic sine; the wavetable transport is not
+    //     available
+    //
+    // setParameters reads only the parameters this chain has; Hiss, Wow,
+    // Capstan, Scrape, Correlation and the choice parameters are ignored.
+
+    template <int Lanes = 8>
+    class TapeBatch
+    {
+    public:
+
+        static constexpr int numLanes = Lanes;
+        static_assert(Lanes >= 2 && Lanes % 2 == 0, "lanes come in stereo pairs");
+
+        TapeBatch()
+        {
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                uint32_t seed = static_cast<uint32_t>(rand());
+                rngState[lane] = seed == 0 ? 0xDEADBEEF + static_cast<uint32_t>(lane) : seed;
+            }
+        }
+
+        // Allocates delay memory; call off the audio thread
+        void prepare(double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            delay.assign(static_cast<size_t>(delaySize) * Lanes, 0.0);
+            reset();
+
+            for (int lane = 0; lane < Lanes; ++lane)
+                updateLaneCoefficients(lane);
+        }
+
+        void reset() noexcept
+        {
+            std::fill(delay.begin(), delay.end(), 0.0);
+            writeIndex = 0;
+
+            auto zero = [](auto& array) { array.fill(0.0); };
+
+            zero(encIir); zero(encAvg); encGain.fill(1.0);
+            zero(decIir); zero(decAvg); decGain.fill(1.0);
+            sweep.fill(3.14159);
+            nextMax.fill(0.5);
+
+            for (auto& stage : hystValue)
+                zero(stage);
+
+            zero(midRoller); zero(lowCutoff); zero(headBumpAcc);
+            zero(bumpA1); zero(bumpA2); zero(bumpB1); zero(bumpB2);
+            zero(lastSample); zero(wasPos); zero(wasNeg);
+        }
+
+        // Copies the current values of a parameter set into one lane
+        void setParameters(int lane, const ParameterValues& values) noexcept
+        {
+            jassert(lane >= 0 && lane < Lanes);
+
+            auto& raw = laneParameters[static_cast<size_t>(lane)];
+            raw.input = values.get(Param::input);
+            raw.tilt = values.get(Param::tilt);
+            raw.shape = values.get(Param::shape);
+            raw.bias = values.get(Param::bias);
+            raw.flutter = values.get(Param::flutter);
+            raw.speed = values.get(Param::speed);
+            raw.bumpHead = values.get(Param::bumpHead);
+            raw.bumpHz = values.get(Param::bumpHz);
+            raw.output = values.get(Param::output);
+
+            updateLaneCoefficients(lane);
+        }
+
+        // inputs/outputs hold one planar channel per lane; lanes at or beyond
+        // numActiveLanes are processed on silence and their output discarded
+        template <typename SampleType>
+        void process(const SampleType* const* inputs, SampleType* const* outputs, int numSamples, int numActiveLanes = Lanes) noexcept
+        {
+            jassert(numActiveLanes <= Lanes);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                alignas(64) std::array<double, Lanes> x;
+
+                for (int lane = 0; lane < Lanes; ++lane)
+                    x[lane] = lane < numActiveLanes ? static_cast<double>(inputs[lane][i]) : 0.0;
+
+                processFrame(x);
+
+                for (int lane = 0; lane < numActiveLanes; ++lane)
+                    outputs[lane][i] = static_cast<SampleType>(x[lane]);
+            }
+        }
+
+    private:
+
+        using LaneArray = std::array<double, Lanes>;
+        static constexpr int delaySize = 1002;
+        static constexpr int hysteresisStages = 9;
+
+        struct RawParameters
+        {
+            float input = 0.5f, tilt = 0.5f, shape = 0.5f, bias = 0.5f;
+            float flutter = 0.5f, speed = 0.5f, bumpHead = 0.5f, bumpHz = 75.0f, output = 0.5f;
+        };
+
+        // Same derivation as TapeDSP::updateParameters, for one lane
+        void updateLaneCoefficients(int lane) noexcept
+        {
+            const auto& raw = laneParameters[static_cast<size_t>(lane)];
+            const double overallscale = sampleRate / 44100.0;
+
+            inputGain[lane] = std::pow(raw.input * 0.5 * 2.0, 2.0);
+            outputGain[lane] = raw.output;
+
+            encAmount[lane] = raw.tilt * 2.0;
+            decAmount[lane] = std::max(-1.0, (1.0 - raw.tilt) * -2.0);
+
+            encFreq[lane] = (1.0 - raw.shape) / overallscale;
+            decFreq[lane] = raw.shape / overallscale;
+            midFreq[lane] = ((raw.shape * 0.618) + 0.382) / overallscale;
+
+            flutterDepth[lane] = std::min(498.0, std::pow(static_cast<double>(raw.flutter), 6) * overallscale * 50.0);
+            flutterSpeed[lane] = (0.02 * std::pow(static_cast<double>(raw.speed), 3)) / overallscale;
+            anyFlutter = std::any_of(flutterDepth.begin(), flutterDepth.end(), [](double depth) { return depth > 0.0; });
+
+            headBumpMix[lane] = raw.bumpHead * 0.5;
+            headBumpDrive[lane] = (raw.bumpHead * 0.1) / overallscale;
+            subFreq[lane] = (std::sin(raw.bumpHead * 3.14159265358979323846) * 0.008) / overallscale;
+            cubicScale = 0.0618 / std::sqrt(overallscale);
+
+            const double bumpHz = std::max(1.0, static_cast<double>(raw.bumpHz));
+            Biquad a, b;
+            a.setCoefficients(bumpHz, 0.618033988, sampleRate);
+            b.setCoefficients(bumpHz * 0.9375, 0.618033988, sampleRate);
+            bumpA0[lane] = a.a0; bumpA2c[lane] = a.a2; bumpAb1[lane] = a.b1; bumpAb2[lane] = a.b2;
+            bumpB0[lane] = b.a0; bumpB2c[lane] = b.a2; bumpBb1[lane] = b.b1; bumpBb2[lane] = b.b2;
+
+            // Hysteresis, as HysteresisProcessor::updateThresholds / process
+            const double formattedBias = (raw.bias * 2.0) - 1.0;
+            double overBias = std::pow(1.0 - (formattedBias > 0.0 ? formattedBias * 0.75 : formattedBias), 3) / overallscale;
+            if (formattedBias < 0.0)
+                overBias = 1.0 / overallscale;
+
+            for (int stage = hysteresisStages - 1; stage >= 0; --stage)
+            {
+                hystThreshold[static_cast<size_t>(stage)][lane] = overBias;
+                overBias *= 1.61803398875;
+            }
+
+            const double underBias = formattedBias > 0.0 ? 0.0 : (std::pow(formattedBias, 4) * 0.25) / overallscale;
+            hystUnderActive[lane] = underBias > 0.0 ? 1.0 : 0.0;
+            hystInvUnderBias[lane] = underBias > 0.0 ? 1.0 / underBias : 0.0;
+            hystActive[lane] = std::abs(formattedBias) > 0.001 ? 1.0 : 0.0;
+        }
+
+        // sin(x) for |x| <= pi/2, odd Taylor polynomial to x^15
+        static double sinPoly(double x) noexcept
+        {
+            const double x2 = x * x;
+            return x * (1.0 + x2 * (-1.0 / 6.0 + x2 * (1.0 / 120.0 + x2 * (-1.0 / 5040.0 + x2 * (1.0 / 362880.0
+                     + x2 * (-1.0 / 39916800.0 + x2 * (1.0 / 6227020800.0 + x2 * (-1.0 / 1307674368000.0))))))));
+        }
+
+        // 1 - cos(x) for 0 <= x <= pi/2, without cancellation
+        static double oneMinusCosPoly(double x) noexcept
+        {
+            const double x2 = x * x;
+            return x2 * (0.5 + x2 * (-1.0 / 24.0 + x2 * (1.0 / 720.0 + x2 * (-1.0 / 40320.0 + x2 * (1.0 / 3628800.0
+                     + x2 * (-1.0 / 479001600.0 + x2 * (1.0 / 87178291200.0 + x2 * (-1.0 / 20922789888000.0))))))));
+        }
+
+        // sin(x) for x in [-pi / 2, 5 pi / 2], folded onto sinPoly's range
+        static double sinFolded(double x) noexcept
+        {
+            const double centred = x - 3.14159265358979323846;
+            const double folded = std::abs(centred) > 1.57079632679489661923
+                                ? std::copysign(3.14159265358979323846, centred) - centred
+                                : centred;
+            return -sinPoly(folded);
+        }
+
+        // log(y) for y >= 1: exponent from the bit pattern, atanh series on the
+        // mantissa. The exponent goes through the 2^52 bias trick rather than an
+        // integer conversion, which keeps the lane loop if-convertible.
+        static double logPoly(double y) noexcept
+        {
+            const auto bits = std::bit_cast<uint64_t>(y);
+            const double exponent = std::bit_cast<double>((bits >> 52) | 0x4330000000000000ull) - (4503599627370496.0 + 1023.0);
+            const double m = std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+
+            const double t = (m - 1.0) / (m + 1.0);
+            const double t2 = t * t;
+            const double series = 2.0 * t * (1.0 + t2 * (1.0 / 3.0 + t2 * (1.0 / 5.0 + t2 * (1.0 / 7.0 + t2 * (1.0 / 9.0
+                                    + t2 * (1.0 / 11.0 + t2 * (1.0 / 13.0 + t2 * (1.0 / 15.0 + t2 * (1.0 / 17.0)))))))));
+
+            return (exponent * 0.69314718055994530942) + series;
+        }
+
+        static double clamp(double v, double limit) noexcept
+        {
+            return v > limit ? limit : (v < -limit ? -limit : v);
+        }
+
+        void compand(LaneArray& x, LaneArray& iir, LaneArray& avg, LaneArray& gain,
+                     const LaneArray& amount, const LaneArray& freq, double factor, double avgFactor) noexcept
+        {
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                iir[lane] = (iir[lane] * (1.0 - freq[lane])) + (x[lane] * freq[lane]);
+
+                const double high = x[lane] - iir[lane];
+                const double highPart = clamp((high * factor) + avg[lane], 1.0);
+                avg[lane] = high * avgFactor;
+
+                // Same curve as CompanderBand, including its adjust > 0 guard
+                const double absHigh = std::abs(highPart);
+                const double adjust = logPoly(1.0 + (255.0 * absHigh)) / 2.40823996531;
+                const double curve = absHigh / (adjust > 0.0 ? adjust : 1.0);
+
+                // A silent detector leaves the gain alone and adds nothing back
+                const double weight = absHigh > 0.0 ? freq[lane] : 0.0;
+                gain[lane] = (gain[lane] * (1.0 - weight)) + (curve * weight);
+                x[lane] += (highPart * gain[lane]) * amount[lane];
+            }
+        }
+
+        double lagrange(int lane, int baseIndex, double frac) const noexcept
+        {
+            const double d_2 = frac + 2.0, d_1 = frac + 1.0, d0 = frac;
+            const double d1 = frac - 1.0, d2 = frac - 2.0, d3 = frac - 3.0;
+
+            const double c_2 = (d_1 * d0 * d1 * d2 * d3) * -0.00833333333333333;
+            const double c_1 = (d_2 * d0 * d1 * d2 * d3) * 0.04166666666666667;
+            const double c0  = (d_2 * d_1 * d1 * d2 * d3) * -0.08333333333333333;
+            const double c1  = (d_2 * d_1 * d0 * d2 * d3) * 0.08333333333333333;
+            const double c2  = (d_2 * d_1 * d0 * d1 * d3) * -0.04166666666666667;
+            const double c3  = (d_2 * d_1 * d0 * d1 * d2) * 0.00833333333333333;
+
+            auto get = [&](int offset)
+            {
+                // baseIndex + offset stays within [-2, 1998]
+                const int index = baseIndex + offset;
+                const int wrapped = index < 0 ? index + 1000 : (index >= 1000 ? index - 1000 : index);
+                return delay[static_cast<size_t>(wrapped * Lanes + lane)];
+            };
+
+            return (get(-2) * c_2) + (get(-1) * c_1) + (get(0) * c0) + (get(1) * c1) + (get(2) * c2) + (get(3) * c3);
+        }
+
+        double nextRandom(int lane) noexcept
+        {
+            auto& state = rngState[lane];
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return static_cast<double>(state) / static_cast<double>(UINT32_MAX);
+        }
+
+        // Lanes without flutter keep their sweep and pass x through, but still
+        // run the read so the loops below stay free of branches
+        void processFlutter(LaneArray& x) noexcept
+        {
+            if (writeIndex < 0 || writeIndex > 999)
+                writeIndex = 0;
+
+            for (int lane = 0; lane < Lanes; ++lane)
+                delay[static_cast<size_t>(writeIndex * Lanes + lane)] = x[lane];
+
+            // Partner values before this frame's update, as seen by both channels
+            const LaneArray sweepBefore = sweep;
+            const LaneArray nextMaxBefore = nextMax;
+
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                const double depth = flutterDepth[lane];
+                readOffset[lane] = depth + (depth * sinFolded(sweep[lane]));
+                sweep[lane] += nextMax[lane] * (depth > 0.0 ? flutterSpeed[lane] : 0.0);
+            }
+
+            // Once per flutter cycle per lane
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                if (sweep[lane] > 6.2831853)
+                {
+                    sweep[lane] -= 6.2831853;
+                    const int partner = lane ^ 1;
+                    const double target = std::sin(sweepBefore[partner] + nextMaxBefore[partner]);
+                    const double flutA = 0.24 + (nextRandom(lane) * 0.74);
+                    const double flutB = 0.24 + (nextRandom(lane) * 0.74);
+                    nextMax[lane] = std::abs(flutA - target) < std::abs(flutB - target) ? flutA : flutB;
+                }
+            }
+
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                const double whole = std::floor(readOffset[lane]);
+                readOffset[lane] = lagrange(lane, writeIndex + static_cast<int>(whole), readOffset[lane] - whole);
+            }
+
+            for (int lane = 0; lane < Lanes; ++lane)
+                x[lane] = flutterDepth[lane] > 0.0 ? readOffset[lane] : x[lane];
+
+            ++writeIndex;
+        }
+
+        void processFrame(LaneArray& x) noexcept
+        {
+            // Denormal check and input gain. Dither is drawn for every lane up
+            // front so both loops stay free of branches.
+            for (int lane = 0; lane < Lanes; ++lane)
+                dither[lane] = nextRandom(lane) * 1.18e-17;
+
+            for (int lane = 0; lane < Lanes; ++lane)
+                x[lane] = (std::abs(x[lane]) < 1.18e-23 ? dither[lane] : x[lane]) * inputGain[lane];
+
+            // A. Encode
+            compand(x, encIir, encAvg, encGain, encAmount, encFreq, 2.848, 1.152);
+
+            // B. Flutter
+            if (anyFlutter)
+                processFlutter(x);
+
+            // C. Hysteresis
+            for (int stage = 0; stage < hysteresisStages; ++stage)
+            {
+                auto& value = hystValue[static_cast<size_t>(stage)];
+                const auto& threshold = hystThreshold[static_cast<size_t>(stage)];
+
+                for (int lane = 0; lane < Lanes; ++lane)
+                {
+                    const double held = value[lane] / 0.975;
+                    const double stuck = std::abs(x[lane] - held) * hystInvUnderBias[lane];
+                    const bool isStuck = hystUnderActive[lane] > 0.0 && stuck < 1.0;
+                    double v = isStuck ? (x[lane] * stuck) + (held * (1.0 - stuck)) : x[lane];
+
+                    const double diff = v - value[lane];
+                    v = diff > threshold[lane] ? value[lane] + threshold[lane]
+                      : (-diff > threshold[lane] ? value[lane] - threshold[lane] : v);
+
+                    const bool active = hystActive[lane] > 0.0;
+                    value[lane] = active ? v * 0.975 : value[lane];
+                    x[lane] = active ? v : x[lane];
+                }
+            }
+
+            // D. Saturation and head bump
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                midRoller[lane] = (midRoller[lane] * (1.0 - midFreq[lane])) + (x[lane] * midFreq[lane]);
+                double highs = x[lane] - midRoller[lane];
+                double lows = midRoller[lane];
+
+                lowCutoff[lane] = (lowCutoff[lane] * (1.0 - subFreq[lane])) + (lows * subFreq[lane]);
+                lows = subFreq[lane] > 0.0 ? lows - lowCutoff[lane] : lows;
+
+                lows = sinPoly(clamp(lows, 1.570796));
+
+                double thinned = oneMinusCosPoly(std::min(std::abs(highs) * 1.570796, 1.570796));
+                highs -= highs < 0.0 ? -thinned : thinned;
+
+                // Head bump: cubic accumulator into two bandpass biquads. The
+                // filters run on every lane; a mix of zero removes the result.
+                double& acc = headBumpAcc[lane];
+                acc += lows * headBumpDrive[lane];
+                acc -= acc * acc * acc * cubicScale;
+
+                const double outA = (acc * bumpA0[lane]) + bumpA1[lane];
+                bumpA1[lane] = -(outA * bumpAb1[lane]) + bumpA2[lane];
+                bumpA2[lane] = (acc * bumpA2c[lane]) - (outA * bumpAb2[lane]);
+
+                const double outB = (outA * bumpB0[lane]) + bumpB1[lane];
+                bumpB1[lane] = -(outB * bumpBb1[lane]) + bumpB2[lane];
+                bumpB2[lane] = (outA * bumpB2c[lane]) - (outB * bumpBb2[lane]);
+
+                x[lane] = lows + highs + (outB * headBumpMix[lane]);
+            }
+
+            // E. Decode
+            compand(x, decIir, decAvg, decGain, decAmount, decFreq, 2.628, 1.372);
+
+            // Output gain and soft clipper
+            for (int lane = 0; lane < Lanes; ++lane)
+            {
+                double sample = clamp(x[lane] * outputGain[lane], 4.0);
+                double last = lastSample[lane];
+
+                if (wasPos[lane] > 0.0)
+                    last = sample < last ? 0.7058208 + (sample * 0.2609148) : 0.2491717 + (last * 0.7390851);
+
+                const bool pos = sample > 0.9549925859;
+                sample = pos ? 0.7058208 + (last * 0.2609148) : sample;
+
+                if (wasNeg[lane] > 0.0)
+                    last = sample > last ? -0.7058208 + (sample * 0.2609148) : -0.2491717 + (last * 0.7390851);
+
+                const bool neg = sample < -0.9549925859;
+                sample = neg ? -0.7058208 + (last * 0.2609148) : sample;
+
+                wasPos[lane] = pos ? 1.0 : 0.0;
+                wasNeg[lane] = neg ? 1.0 : 0.0;
+                x[lane] = last;
+                lastSample[lane] = sample;
+            }
+        }
+
+        double sampleRate = 44100.0;
+        std::array<RawParameters, Lanes> laneParameters {};
+
+        // Per-lane coefficients
+        LaneArray inputGain {}, outputGain {};
+        LaneArray encAmount {}, decAmount {}, encFreq {}, decFreq {}, midFreq {}, subFreq {};
+        LaneArray flutterDepth {}, flutterSpeed {};
+        bool anyFlutter = false;
+        LaneArray headBumpMix {}, headBumpDrive {};
+        LaneArray bumpA0 {}, bumpA2c {}, bumpAb1 {}, bumpAb2 {};
+        LaneArray bumpB0 {}, bumpB2c {}, bumpBb1 {}, bumpBb2 {};
+        std::array<LaneArray, hysteresisStages> hystThreshold {};
+        LaneArray hystInvUnderBias {}, hystUnderActive {}, hystActive {};
+        double cubicScale = 0.0618;
+
+        // Per-lane state
+        LaneArray encIir {}, encAvg {}, encGain {}, decIir {}, decAvg {}, decGain {};
+        LaneArray sweep {}, nextMax {};
+        std::array<LaneArray, hysteresisStages> hystValue {};
+        LaneArray midRoller {}, lowCutoff {}, headBumpAcc {};
+        LaneArray bumpA1 {}, bumpA2 {}, bumpB1 {}, bumpB2 {};
+        LaneArray lastSample {}, wasPos {}, wasNeg {};
+        std::array<uint32_t, Lanes> rngState {};
+        LaneArray dither {}, readOffset {};
+
+        // Interleaved by lane: delay[index * Lanes + lane]
+        std::vector<double> delay;
+        int writeIndex = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(TapeBatch)
+    };
+}
@@ -1,8 +1,19 @@
 #pragma once
 
-#include <Includes.h>
+#include <DSPIncludes.h>
+#include "ADAA.h"
+#include "JilesAtherton.h"
+#include "MultiRateCompander.h"
+#include "NoiseGenerator.h"
+#include "ParameterRegistry.h"
+#include "QualityGovernor.h"
+#include "SaturationTables.h"
+#include "SignalGuard.h"
+#include "TapeStateArena.h"
+#include "TransportModulation.h"
 #include <array>
 #include <cmath>
+#include <cstdlib>
 
 namespace MarsDSP::DSP {
 
@@ -10,40 +21,71 @@ namespace MarsDSP::DSP {
     // HELPER CLASSES
     // ==============================================================================
 
-    // 1. XORShift Random Generator
-    struct RandomGenerator
+    // 1. Tape Hiss
+    // Playback noise of one channel. White noise is tilted towards the highs
+    // by taking most of its lows away, at a floor set by the hiss control, and
+    // raised by modulation noise, which follows the signal level. Added after
+    // the saturation, ahead of the decoder, so the decode de-emphasis shapes
+    // it the way noise reduction would.
+    struct TapeHiss
     {
-        uint32_t state = 0xDEADBEEF;
+        // Share of the lows removed, and how far a full-scale signal raises
+        // the noise above its floor (modulation noise)
+        static constexpr double lowCut = 0.8;
+        static constexpr double modulationDepth = 3.0;
 
-        void seed(uint32_t s) { state = s; }
-        
-        // Returns random double 0.0 to 1.0 (approx)
-        double nextDouble()
+        double lowpass = 0.0;
+        double envelope = 0.0;
+
+        bool isFinite() const noexcept { return allFinite(lowpass, envelope); }
+
+        double process(double sample, double noise, double level, double shape, double follow) noexcept
         {
-            state ^= state << 13;
-            state ^= state >> 17;
-            state ^= state << 5;
-            return static_cast<double>(state) / static_cast<double>(UINT32_MAX);
+            lowpass += (noise - lowpass) * shape;
+            envelope += (std::abs(sample) - envelope) * follow;
+            return sample + ((noise - (lowCut * lowpass)) * level * (1.0 + (modulationDepth * envelope)));
         }
     };
 
     // 2. Biquad Filter
     struct Biquad
     {
+        struct Coefficients
+        {
+            double a0 = 0, a1 = 0, a2 = 0, b1 = 0, b2 = 0;
+        };
+
         double a0 = 0, a1 = 0, a2 = 0, b1 = 0, b2 = 0;
         double sL1 = 0, sL2 = 0, sR1 = 0, sR2 = 0;
 
-        void setCoefficients(double freq, double reso, double sampleRate)
+        static Coefficients design(double freq, double reso, double sampleRate) noexcept
         {
+            Coefficients k;
             double K = std::tan(M_PI * (freq / sampleRate)); 
             double norm = 1.0 / (1.0 + K / reso + K * K);
-            a0 = K / reso * norm;
-            a1 = 0.0;
-            a2 = -a0;
-            b1 = 2.0 * (K * K - 1.0) * norm;
-            b2 = (1.0 - K / reso + K * K) * norm;
+            k.a0 = K / reso * norm;
+            k.a1 = 0.0;
+            k.a2 = -k.a0;
+            k.b1 = 2.0 * (K * K - 1.0) * norm;
+            k.b2 = (1.0 - K / reso + K * K) * norm;
+            return k;
         }
 
+        void setCoefficients(double freq, double reso, double sampleRate)
+        {
+            setCoefficients(design(freq, reso, sampleRate));
+        }
+
+        void setCoefficients(const Coefficients& k) noexcept
+        {
+            a0 = k.a0; a1 = k.a1; a2 = k.a2; b1 = k.b1; b2 = k.b2;
+        }
+
+        // Clears the filter memory and keeps the coefficients
+        void resetState() noexcept { sL1 = sL2 = sR1 = sR2 = 0.0; }
+
+        bool isFinite() const noexcept { return allFinite(sL1, sL2, sR1, sR2); }
+
         void processL(double& sample)
         {
             double out = (sample * a0) + sL1;
@@ -75,8 +117,26 @@ namespace MarsDSP::DSP {
 
     public:
 
-        void updateThresholds(double bias, double sampleRate)
+        using Thresholds = std::array<double, STAGES>;
+
+        // Clears the stage memory and keeps the thresholds
+        void resetState() noexcept
+        {
+            for (auto& stage : stages)
+                stage.valL = stage.valR = 0.0;
+        }
+
+        bool isFinite() const noexcept
         {
+            return std::all_of(stages.begin(), stages.end(), [](const Stage& s) { return allFinite(s.valL, s.valR); });
+        }
+
+        // For containment tests: NaN in the first stage's left memory
+        void poisonState() noexcept { stages[0].valL = std::numeric_limits<double>::quiet_NaN(); }
+
+        static Thresholds computeThresholds(double bias, double sampleRate) noexcept
+        {
+            Thresholds thresholds {};
             double overallscale = sampleRate / 44100.0;
             double formattedBias = (bias * 2.0) - 1.0;
 
@@ -86,9 +146,22 @@ namespace MarsDSP::DSP {
 
             for (int i = STAGES - 1; i >= 0; --i)
             {
-                stages[i].threshold = overBias;
+                thresholds[static_cast<size_t>(i)] = overBias;
                 overBias *= 1.61803398875;
             }
+
+            return thresholds;
+        }
+
+        void setThresholds(const Thresholds& thresholds) noexcept
+        {
+            for (size_t i = 0; i < stages.size(); ++i)
+                stages[i].threshold = thresholds[i];
+        }
+
+        void updateThresholds(double bias, double sampleRate)
+        {
+            setThresholds(computeThresholds(bias, sampleRate));
         }
 
         void process(double& L, double& R, double biasParameter, double sampleRate)
@@ -143,6 +216,8 @@ namespace MarsDSP::DSP {
         double compGain = 1.0;
         double avgLevel = 0.0;
 
+        bool isFinite() const noexcept { return allFinite(iirFilter, compGain, avgLevel); }
+
         void process(double& sample, double amount, double freq, bool isDecode)
         {
             // Low pass filter state update
@@ -167,7 +242,9 @@ namespace MarsDSP::DSP {
             
             double absHigh = std::abs(highPart);
             
-            if (absHigh > 0.0)
+            // Written so NaN state reaches the output, where ProcessBlock
+            // catches it, instead of silently disabling the band for good
+            if (! (absHigh <= 0.0))
             {
                 // Non-linear companding curve
                 double adjust = std::log(1.0 + (255.0 * absHigh)) / 2.40823996531;
@@ -187,28 +264,68 @@ namespace MarsDSP::DSP {
     // MAIN CLASS
     // ==============================================================================
 
-    class TapeDSP {
+    // Per-sample state is laid out first and the object is cache-line aligned,
+    // so the hot part of an instance spans as few lines as possible. Flutter
+    // delay memory is cold and lives in a TapeStateArena slab (see there).
+    class alignas(64) TapeDSP {
     public:
+        static constexpr int maxSubBlockSize = 64;
+
+        // Highest rate the fixed flutter delay covers at full depth
+        static constexpr double maxSampleRate = 384000.0;
+
         TapeDSP()
         {
-            uint32_t sL = static_cast<uint32_t>(rand());
-            if (sL == 0)
-                sL = 0xDEADBEEF;
-            rngL.seed(sL);
-            
-            uint32_t sR = static_cast<uint32_t>(rand());
-            if (sR == 0)
-                sR = 0xCAFEBABE;
-            rngR.seed(sR);
+            ditherNoise.seed(static_cast<uint32_t>(rand()));
+            hissNoise.seed(static_cast<uint32_t>(rand()));
+            flutterNoise.seed(static_cast<uint32_t>(rand()));
+        }
+
+        ~TapeDSP()
+        {
+            if (flutterDelay != nullptr)
+                arena->release(flutterDelay);
+
+            if (isRegistered)
+                arena->unregisterClient();
+        }
+
+        // Draw flutter delay memory from a different arena. Call before prepare.
+        void setArena(TapeStateArena& newArena)
+        {
+            jassert(! isRegistered);
+            arena = &newArena;
         }
 
+        bool hasFlutterDelay() const noexcept { return flutterDelay != nullptr; }
+
+        double getSampleRate() const noexcept { return sampleRate; }
+
         void prepare(const juce::dsp::ProcessSpec& spec)
         {
+            jassert(spec.sampleRate > 0.0 && spec.sampleRate <= maxSampleRate);
             sampleRate = spec.sampleRate;
             
+            // Make sure the arena can hand this instance a delay slab at any time
+            if (! isRegistered)
+            {
+                arena->registerClient();
+                isRegistered = true;
+            }
+
+            reset();
+        }
+
+        // Resets the delay and the helper processors; allocates nothing, so it
+        // is safe on the audio thread
+        void reset() noexcept
+        {
             // Reset Delay Lines
-            std::fill(std::begin(delayL), std::end(delayL), 0.0);
-            std::fill(std::begin(delayR), std::end(delayR), 0.0);
+            if (flutterDelay != nullptr)
+                flutterDelay->clear();
+
+            writeIndex = 0;
+            flutterIdleSamples = 0;
             
             // Reset Helper Classes
             hysteresis = HysteresisProcessor();
@@ -216,127 +333,795 @@ namespace MarsDSP::DSP {
             compEncodeR = CompanderBand();
             compDecodeL = CompanderBand();
             compDecodeR = CompanderBand();
+            multiRateEncode.reset();
+            multiRateDecode.reset();
+            transport.reset();
+
+            jilesAtherton.reset();
+            hissL = TapeHiss();
+            hissR = TapeHiss();
+
+            lowsShaperL.reset();  lowsShaperR.reset();
+            highsShaperL.reset(); highsShaperR.reset();
+            clipShaperL.reset();  clipShaperR.reset();
+
+            // The first applyControls after a reset switches without a crossfade
+            qualityFade.remaining = 0;
+            offsetGlide.remaining = 0;
+            companderFade.remaining = 0;
+            hasControls = false;
         }
 
+        // Moves a prepared engine to a new sample rate without clearing it.
+        // Filter, compander and hysteresis state is in signal units and carries
+        // over as it is; the coefficients that depend on the rate are redesigned
+        // by the next applyControls, which must come before the next
+        // processSamples. The flutter delay keeps its history and positions: its
+        // length is in samples, so what it holds plays out at the new rate, like
+        // a brief speed change, where resampling it would make the read point
+        // jump. Counters kept in samples are rescaled. Allocates nothing; safe
+        // on the audio thread.
+        void changeSampleRate(double newSampleRate) noexcept
+        {
+            jassert(newSampleRate > 0.0 && newSampleRate <= maxSampleRate);
+
+            const double ratio = newSampleRate / sampleRate;
+            sampleRate = newSampleRate;
+
+            auto rescale = [ratio](int samples) { return static_cast<int>(std::lround(samples * ratio)); };
+
+            flutterIdleSamples = rescale(flutterIdleSamples);
+
+            if (qualityFade.remaining > 0)
+            {
+                qualityFade.length = std::max(1, rescale(qualityFade.length));
+                qualityFade.remaining = std::clamp(rescale(qualityFade.remaining), 1, qualityFade.length);
+            }
+
+            if (companderFade.remaining > 0)
+            {
+                companderFade.length = std::max(1, rescale(companderFade.length));
+                companderFade.remaining = std::clamp(rescale(companderFade.remaining), 1, companderFade.length);
+            }
+        }
+
+        // Smoothed parameter values for one control block. They are read from the
+        // smoother once and can be shared by several engines, e.g. the tape
+        // generations of a ProcessBlock.
+        struct ControlValues
+        {
+            double input = 0.5, output = 0.5, tilt = 0.5, shape = 0.5;
+            double flutter = 0.5, flutterSpeed = 0.5, bumpHead = 0.5, bumpHz = 75.0, bias = 0.5;
+            double hiss = 0.0;
+            double wow = 0.6, capstan = 0.3, scrape = 0.1, correlation = 0.5;
+            int antialias = 0, hysteresis = 0, compander = 0, flutterMode = 0;
+
+            // Per-sample input gain, output gain and bias over the control block
+            int rampLength = 1;
+            bool gainsRamping = false;
+            alignas(64) std::array<float, maxSubBlockSize> inputRamp {};
+            alignas(64) std::array<float, maxSubBlockSize> outputRamp {};
+            alignas(64) std::array<float, maxSubBlockSize> biasRamp {};
+        };
+
+        // Everything applyControls derives from the continuous controls at one
+        // sample rate. No engine state goes in, so a set can be worked out on
+        // any thread ahead of time. Two sets blend field by field: the gains and
+        // one-pole coefficients directly, and the head bump biquads because the
+        // stable region of a second order section's feedback pair is convex, so
+        // a blend of two stable sections is stable too.
+        struct CoefficientSet
+        {
+            double inputGain = 1.0, outputGain = 1.0;
+            double dublyEncodeAmount = 0.0, dublyDecodeAmount = 0.0;
+            double iirEncFreq = 0.0, iirDecFreq = 0.0, iirMidFreq = 0.0, iirSubFreq = 0.0;
+            double flutterDepth = 0.0, flutterSpeed = 0.0, flutterSpeedParam = 0.0;
+            double headBumpMix = 0.0, headBumpDrive = 0.0;
+            double hissLevel = 0.0, hissShape = 0.0, hissFollow = 0.0;
+            double bias = 0.5;
+            TransportModulation::Settings transport {};
+            Biquad::Coefficients bumpA, bumpB;
+            HysteresisProcessor::Thresholds thresholds {};
+
+            static CoefficientSet blend(const CoefficientSet& a, const CoefficientSet& b, double t) noexcept
+            {
+                auto mix = [t](double x, double y) { return x + ((y - x) * t); };
+                auto mixBiquad = [&mix](const Biquad::Coefficients& x, const Biquad::Coefficients& y)
+                {
+                    return Biquad::Coefficients { mix(x.a0, y.a0), mix(x.a1, y.a1), mix(x.a2, y.a2), mix(x.b1, y.b1), mix(x.b2, y.b2) };
+                };
+
+                CoefficientSet k;
+                k.inputGain = mix(a.inputGain, b.inputGain);
+                k.outputGain = mix(a.outputGain, b.outputGain);
+                k.dublyEncodeAmount = mix(a.dublyEncodeAmount, b.dublyEncodeAmount);
+                k.dublyDecodeAmount = mix(a.dublyDecodeAmount, b.dublyDecodeAmount);
+                k.iirEncFreq = mix(a.iirEncFreq, b.iirEncFreq);
+                k.iirDecFreq = mix(a.iirDecFreq, b.iirDecFreq);
+                k.iirMidFreq = mix(a.iirMidFreq, b.iirMidFreq);
+                k.iirSubFreq = mix(a.iirSubFreq, b.iirSubFreq);
+                k.flutterDepth = mix(a.flutterDepth, b.flutterDepth);
+                k.flutterSpeed = mix(a.flutterSpeed, b.flutterSpeed);
+                k.flutterSpeedParam = mix(a.flutterSpeedParam, b.flutterSpeedParam);
+                k.headBumpMix = mix(a.headBumpMix, b.headBumpMix);
+                k.headBumpDrive = mix(a.headBumpDrive, b.headBumpDrive);
+                k.hissLevel = mix(a.hissLevel, b.hissLevel);
+                k.hissShape = mix(a.hissShape, b.hissShape);
+                k.hissFollow = mix(a.hissFollow, b.hissFollow);
+                k.bias = mix(a.bias, b.bias);
+                k.transport = { mix(a.transport.wow, b.transport.wow), mix(a.transport.flutter, b.transport.flutter),
+                                mix(a.transport.scrape, b.transport.scrape), mix(a.transport.correlation, b.transport.correlation) };
+                k.bumpA = mixBiquad(a.bumpA, b.bumpA);
+                k.bumpB = mixBiquad(a.bumpB, b.bumpB);
+
+                for (size_t i = 0; i < k.thresholds.size(); ++i)
+                    k.thresholds[i] = mix(a.thresholds[i], b.thresholds[i]);
+
+                return k;
+            }
+        };
+
+        template <typename SampleType, typename SmootherType>
+        void processTape(const SampleType* inL, const SampleType* inR, SampleType* outL, SampleType* outR, int numSamples, SmootherType &smoother)
+        {
+            ControlValues controls;
+            readControls(smoother, numSamples, controls);
+            applyControls(controls, numSamples);
+            processSamples(inL, inR, outL, outR, numSamples, controls);
+        }
+
+        // 1a. Reads every parameter once for a control block of numSamples and
+        // advances the smoothers past it. Ramps cover at most maxSubBlockSize
+        // samples and hold their last value beyond that.
         template <typename SmootherType>
-        void processTape(const float* inL, const float* inR, float* outL, float* outR, int numSamples, SmootherType &smoother)
+        static void readControls(SmootherType& smoother, int numSamples, ControlValues& c)
+        {
+            c.rampLength = std::min(numSamples, maxSubBlockSize);
+            smoother.fillRamp(Param::input, c.inputRamp.data(), c.rampLength);
+            smoother.fillRamp(Param::output, c.outputRamp.data(), c.rampLength);
+            smoother.fillRamp(Param::bias, c.biasRamp.data(), c.rampLength);
+
+            const auto last = static_cast<size_t>(c.rampLength - 1);
+            c.gainsRamping = c.inputRamp[0] != c.inputRamp[last] || c.outputRamp[0] != c.outputRamp[last];
+
+            c.input = smoother.next(Param::input);
+            c.output = smoother.next(Param::output);
+            c.tilt = smoother.next(Param::tilt);
+            c.shape = smoother.next(Param::shape);
+            c.flutter = smoother.next(Param::flutter);
+            c.flutterSpeed = smoother.next(Param::speed);
+            c.bumpHead = smoother.next(Param::bumpHead);
+            c.bumpHz = smoother.next(Param::bumpHz);
+            c.bias = smoother.next(Param::bias);
+            c.hiss = smoother.next(Param::hiss);
+            c.wow = smoother.next(Param::wow);
+            c.capstan = smoother.next(Param::capstan);
+            c.scrape = smoother.next(Param::scrape);
+            c.correlation = smoother.next(Param::correlation);
+            c.antialias = smoother.get(Param::antialias);
+            c.hysteresis = smoother.get(Param::hysteresis);
+            c.compander = smoother.get(Param::compander);
+            c.flutterMode = smoother.get(Param::flutterMode);
+
+            if (numSamples > 1)
+                smoother.setSmoother(numSamples - 1, SmootherType::SmootherUpdateMode::liveInRealTime);
+        }
+
+        // Control values for a plain value per parameterTable row (a preset or
+        // snapshot) rather than a smoother; the ramps hold still
+        static void readControls(const std::array<float, numParameters>& values, ControlValues& c) noexcept
+        {
+            auto value = [&values](auto tag) { return static_cast<double>(values[decltype(tag)::index]); };
+
+            c.input = value(Param::input);
+            c.output = value(Param::output);
+            c.tilt = value(Param::tilt);
+            c.shape = value(Param::shape);
+            c.flutter = value(Param::flutter);
+            c.flutterSpeed = value(Param::speed);
+            c.bumpHead = value(Param::bumpHead);
+            c.bumpHz = value(Param::bumpHz);
+            c.bias = value(Param::bias);
+            c.hiss = value(Param::hiss);
+            c.wow = value(Param::wow);
+            c.capstan = value(Param::capstan);
+            c.scrape = value(Param::scrape);
+            c.correlation = value(Param::correlation);
+            c.antialias = juce::roundToInt(values[Param::antialias.index]);
+            c.hysteresis = juce::roundToInt(values[Param::hysteresis.index]);
+            c.compander = juce::roundToInt(values[Param::compander.index]);
+            c.flutterMode = juce::roundToInt(values[Param::flutterMode.index]);
+
+            c.rampLength = 1;
+            c.gainsRamping = false;
+            c.inputRamp[0] = static_cast<float>(c.input);
+            c.outputRamp[0] = static_cast<float>(c.output);
+            c.biasRamp[0] = static_cast<float>(c.bias);
+        }
+
+        // 1b. Works out the coefficients for the control values; any thread
+        static void computeCoefficients(const ControlValues& c, double sampleRate, CoefficientSet& k) noexcept
         {
-            // 1. Update Parameters once per block
-            double inputGain = std::pow(smoother.getInput() * 0.5 * 2.0, 2.0);
-            double outputGain = smoother.getOutput(); 
+            k.inputGain = std::pow(c.input * 0.5 * 2.0, 2.0);
+            k.outputGain = c.output;
             
-            double tiltParam = smoother.getTilt();
-            double dublyEncodeAmount = tiltParam * 2.0;
-            double dublyDecodeAmount = (1.0 - tiltParam) * -2.0;
+            double tiltParam = c.tilt;
+            k.dublyEncodeAmount = tiltParam * 2.0;
+            k.dublyDecodeAmount = (1.0 - tiltParam) * -2.0;
 
-            if (dublyDecodeAmount < -1.0)
-                dublyDecodeAmount = -1.0;
+            if (k.dublyDecodeAmount < -1.0)
+                k.dublyDecodeAmount = -1.0;
 
-            double shapeParam = smoother.getShape();
+            double shapeParam = c.shape;
             double overallscale = sampleRate / 44100.0;
             
-            double iirEncFreq = (1.0 - shapeParam) / overallscale;
-            double iirDecFreq = shapeParam / overallscale;
-            double iirMidFreq = ((shapeParam * 0.618) + 0.382) / overallscale;
+            k.iirEncFreq = (1.0 - shapeParam) / overallscale;
+            k.iirDecFreq = shapeParam / overallscale;
+            k.iirMidFreq = ((shapeParam * 0.618) + 0.382) / overallscale;
 
             // Flutter Setup
-            double flutterDepth = std::pow(smoother.getFlutter(), 6) * overallscale * 50.0;
+            k.flutterDepth = std::pow(c.flutter, 6) * overallscale * 50.0;
 
-            if (flutterDepth > 498.0)
-                flutterDepth = 498.0;
+            if (k.flutterDepth > 498.0)
+                k.flutterDepth = 498.0;
 
-            double flutterSpeed = (0.02 * std::pow(smoother.getFlutterSpeed(), 3)) / overallscale;
+            k.flutterSpeedParam = c.flutterSpeed;
+            k.flutterSpeed = (0.02 * std::pow(k.flutterSpeedParam, 3)) / overallscale;
 
             // Head Bump Setup
-            double headBumpMix = smoother.getBumpHead() * 0.5;
-            double headBumpDrive = (smoother.getBumpHead() * 0.1) / overallscale;
-            double headBumpFreqParam = smoother.getBumpHz();
+            k.headBumpMix = c.bumpHead * 0.5;
+            k.headBumpDrive = (c.bumpHead * 0.1) / overallscale;
+            double headBumpFreqParam = c.bumpHz;
 
             if (headBumpFreqParam < 1.0)
                 headBumpFreqParam = 1.0;
             
-            double subCurve = std::sin(smoother.getBumpHead() * 3.14159265358979323846);
-            double iirSubFreq = (subCurve * 0.008) / overallscale;
+            double subCurve = std::sin(c.bumpHead * 3.14159265358979323846);
+            k.iirSubFreq = (subCurve * 0.008) / overallscale;
             
-            // Update Filter Coefficients
-            if (headBumpMix > 0.0)
+            // Filter Coefficients
+            k.bumpA = Biquad::design(headBumpFreqParam, 0.618033988, sampleRate);
+            k.bumpB = Biquad::design(headBumpFreqParam * 0.9375, 0.618033988, sampleRate); 
+
+            // Hiss level goes with the square of the control: silent at 0, about
+            // -50 dBFS at full, -62 at half and -90 at 10 %. Lows tilted away
+            // below 1.5 kHz, modulation noise following the level over 5 ms
+            k.hissLevel = c.hiss * c.hiss * 0.0032;
+            k.hissShape = 1.0 - std::exp(-2.0 * M_PI * 1500.0 / sampleRate);
+            k.hissFollow = 1.0 - std::exp(-1.0 / (0.005 * sampleRate));
+
+            // Wavetable transport mix; TransportModulation normalises the weights
+            k.transport = { c.wow, c.capstan, c.scrape, c.correlation };
+
+            // Hysteresis Thresholds; the Jiles-Atherton constants follow the bias
+            k.bias = c.bias;
+            k.thresholds = HysteresisProcessor::computeThresholds(k.bias, sampleRate);
+        }
+
+        // 1c. Refreshes every per-block coefficient from the control values
+        void applyControls(const ControlValues& c, int numSamples)
+        {
+            CoefficientSet k;
+            computeCoefficients(c, sampleRate, k);
+            applyCoefficients(k, c, numSamples);
+        }
+
+        // 1d. Installs coefficients worked out earlier, e.g. blended between two
+        // snapshots; only the choice settings are taken from c. Allocates and
+        // designs nothing.
+        void applyCoefficients(const CoefficientSet& k, const ControlValues& c, int numSamples) noexcept
+        {
+            auto& p = blockParameters;
+            rampPosition = 0;
+
+            // Before flutterDepth is replaced, which tells whether to glide
+            const auto newFlutterMode = static_cast<FlutterMode>(c.flutterMode);
+
+            if (newFlutterMode != flutterMode)
+                switchFlutterMode(newFlutterMode);
+
+            p.inputGain = k.inputGain;
+            p.outputGain = k.outputGain;
+            p.dublyEncodeAmount = k.dublyEncodeAmount;
+            p.dublyDecodeAmount = k.dublyDecodeAmount;
+            p.iirEncFreq = k.iirEncFreq;
+            p.iirDecFreq = k.iirDecFreq;
+            p.iirMidFreq = k.iirMidFreq;
+            p.iirSubFreq = k.iirSubFreq;
+            p.flutterDepth = k.flutterDepth;
+            p.flutterSpeed = k.flutterSpeed;
+            p.headBumpMix = k.headBumpMix;
+            p.headBumpDrive = k.headBumpDrive;
+            p.hissLevel = k.hissLevel;
+            p.hissShape = k.hissShape;
+            p.hissFollow = k.hissFollow;
+
+            if (flutterMode == FlutterMode::wavetable)
             {
-                bumpFilterA.setCoefficients(headBumpFreqParam, 0.618033988, sampleRate);
-                bumpFilterB.setCoefficients(headBumpFreqParam * 0.9375, 0.618033988, sampleRate); 
+                transport.setSettings(k.transport);
+                transport.updateRates(k.flutterSpeedParam, sampleRate);
             }
 
-            // Update Hysteresis Thresholds
-            hysteresis.updateThresholds(smoother.getBias(), sampleRate);
+            // Flutter stays off until a delay slab is bound
+            if (! updateFlutterDelay(p.flutterDepth > 0.0, numSamples))
+                p.flutterDepth = 0.0;
 
-            // Advance Smoother
-            if (numSamples > 1)
+            if (p.headBumpMix > 0.0)
             {
-                smoother.setSmoother(numSamples - 1, SmootherType::SmootherUpdateMode::liveInRealTime);
+                bumpFilterA.setCoefficients(k.bumpA);
+                bumpFilterB.setCoefficients(k.bumpB);
             }
 
-            // 2. Process Loop
-            for (int i = 0; i < numSamples; ++i)
+            // The quality level caps the user's antialiasing order and the
+            // flutter interpolation; changes of either are crossfaded
+            const auto& quality = qualityLevels[static_cast<size_t>(qualityLevel)];
+            const auto antialias = std::min(static_cast<AntialiasMode>(c.antialias), quality.maxAntialias);
+
+            if (hasControls && (antialias != p.antialias || quality.interpolationPoints != p.interpolationPoints))
+                beginQualityFade();
+
+            p.antialias = antialias;
+            p.interpolationPoints = quality.interpolationPoints;
+            hasControls = true;
+
+            // Hysteresis thresholds, or the Jiles-Atherton constants
+            const int hysteresisMode = c.hysteresis;
+
+            if (hysteresisMode > 0)
             {
-                double L = inL[i];
-                double R = inR[i];
+                // Entering the model starts from demagnetised tape
+                if (! p.jilesAtherton)
+                    jilesAtherton.reset();
+
+                jilesAtherton.setSolver(quality.rk2Only ? HysteresisSolver::rk2 : static_cast<HysteresisSolver>(hysteresisMode - 1));
+                jilesAtherton.updateConstants(k.bias, sampleRate);
+            }
+
+            p.jilesAtherton = hysteresisMode > 0;
+            hysteresis.setThresholds(k.thresholds);
+
+            companderMode = static_cast<CompanderMode>(c.compander);
+            updateCompander();
+        }
 
-                // Denormal check
-                if (std::abs(L) < 1.18e-23) L = rngL.nextDouble() * 1.18e-17;
-                if (std::abs(R) < 1.18e-23) R = rngR.nextDouble() * 1.18e-17;
+        // 2. Runs the tape chain with the coefficients from the last applyControls;
+        // c must be the same control values, for the per-sample ramps
+        template <typename SampleType>
+        void processSamples(const SampleType* inL, const SampleType* inR, SampleType* outL, SampleType* outR, int numSamples, const ControlValues& c)
+        {
+            const auto& p = blockParameters;
+            const double inputGain = p.inputGain, outputGain = p.outputGain;
+            const double dublyEncodeAmount = p.dublyEncodeAmount, dublyDecodeAmount = p.dublyDecodeAmount;
+            const double iirEncFreq = p.iirEncFreq, iirDecFreq = p.iirDecFreq, iirMidFreq = p.iirMidFreq;
+            const double iirSubFreq = p.iirSubFreq, headBumpMix = p.headBumpMix, headBumpDrive = p.headBumpDrive;
+            const double flutterDepth = p.flutterDepth, flutterSpeed = p.flutterSpeed;
+            const double hissLevel = p.hissLevel, hissShape = p.hissShape, hissFollow = p.hissFollow;
+            const auto antialias = p.antialias;
+
+            // Stage by stage over short sub-blocks that stay in L1
+            alignas(64) std::array<double, maxSubBlockSize> blockL;
+            alignas(64) std::array<double, maxSubBlockSize> blockR;
+
+            // Random numbers for the denormal dither and the hiss, a sub-block
+            // at a time
+            alignas(64) std::array<float, maxSubBlockSize> randomL;
+            alignas(64) std::array<float, maxSubBlockSize> randomR;
+
+            for (int offset = 0; offset < numSamples; offset += maxSubBlockSize)
+            {
+                const int n = std::min(maxSubBlockSize, numSamples - offset);
+                double* L = blockL.data();
+                double* R = blockR.data();
+
+                // A quality or antialiasing change is being crossfaded
+                const bool fading = qualityFade.remaining > 0;
+
+                ditherNoise.fillUniform(randomL.data(), randomR.data(), n);
+
+                for (int i = 0; i < n; ++i)
+                {
+                    L[i] = inL[offset + i];
+                    R[i] = inR[offset + i];
+
+                    // Denormal check
+                    if (std::abs(L[i]) < 1.18e-23) L[i] = randomL[static_cast<size_t>(i)] * 1.18e-17;
+                    if (std::abs(R[i]) < 1.18e-23) R[i] = randomR[static_cast<size_t>(i)] * 1.18e-17;
+                }
 
                 // Input Gain
-                if (inputGain != 1.0)
+                if (c.gainsRamping)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const double gain = rampAt(c.inputRamp, c, offset + i);
+                        L[i] *= gain * gain; R[i] *= gain * gain;
+                    }
+                }
+
+                else if (inputGain != 1.0)
                 {
-                    L *= inputGain; R *= inputGain;
+                    for (int i = 0; i < n; ++i)
+                    {
+                        L[i] *= inputGain; R[i] *= inputGain;
+                    }
                 }
 
                 // A. Encode (Pre-emphasis)
-                compEncodeL.process(L, dublyEncodeAmount, iirEncFreq, false);
-                compEncodeR.process(R, dublyEncodeAmount, iirEncFreq, false);
+                if (companderFade.remaining > 0)
+                {
+                    alignas(64) std::array<double, maxSubBlockSize> fromL;
+                    alignas(64) std::array<double, maxSubBlockSize> fromR;
+                    std::copy_n(L, n, fromL.data());
+                    std::copy_n(R, n, fromR.data());
+
+                    processEncode(companderFade.from, fromL.data(), fromR.data(), n, dublyEncodeAmount, iirEncFreq);
+                    processEncode(runningCompander, L, R, n, dublyEncodeAmount, iirEncFreq);
+                    companderFade.blend(L, R, fromL.data(), fromR.data(), n);
+                }
+
+                else
+                {
+                    processEncode(runningCompander, L, R, n, dublyEncodeAmount, iirEncFreq);
+                }
 
                 // B. Tape Transport (Flutter)
-                if (flutterDepth > 0.0)
+                if (flutterDepth > 0.0 && flutterMode == FlutterMode::wavetable)
                 {
-                    processFlutter(L, R, flutterDepth, flutterSpeed);
+                    alignas(64) std::array<double, maxSubBlockSize> offsetL;
+                    alignas(64) std::array<double, maxSubBlockSize> offsetR;
+                    transport.generate(offsetL.data(), offsetR.data(), n, flutterDepth);
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        if (fading) qualityFade.moveTo(i);
+                        processModulatedDelay(L[i], R[i], offsetL[static_cast<size_t>(i)], offsetR[static_cast<size_t>(i)]);
+                    }
+
+                    flutterOffset = offsetL[static_cast<size_t>(n - 1)];
+                }
+
+                else if (flutterDepth > 0.0)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        if (fading) qualityFade.moveTo(i);
+                        processFlutter(L[i], R[i], flutterDepth, flutterSpeed);
+                    }
+
+                    flutterOffset = flutterDepth + (flutterDepth * std::sin(sweepL));
+                }
+
+                else
+                {
+                    flutterOffset = 0.0;
+                }
+
+                // C. Hysteresis (Bias & Slew Limiting, or Jiles-Atherton)
+                if (p.jilesAtherton)
+                {
+                    jilesAtherton.process(L, R, n);
                 }
 
-                // C. Hysteresis (Bias & Slew Limiting)
-                hysteresis.process(L, R, smoother.getBias(), sampleRate);
+                else
+                {
+                    for (int i = 0; i < n; ++i)
+                        hysteresis.process(L[i], R[i], rampAt(c.biasRamp, c, offset + i), sampleRate);
+                }
 
                 // D. Tape Saturation Core (Split Band Saturation)
-                processSaturation(L, iirMidRollerL, iirLowCutoffL, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, true);
-                processSaturation(R, iirMidRollerR, iirLowCutoffR, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, false);
+                if (saturationMode == SaturationMode::table && antialias == AntialiasMode::off && ! fading)
+                {
+                    processSaturationBlock(L, n, iirMidRollerL, iirLowCutoffL, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, true);
+                    processSaturationBlock(R, n, iirMidRollerR, iirLowCutoffR, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, false);
+                }
+
+                else for (int i = 0; i < n; ++i)
+                {
+                    if (fading) qualityFade.moveTo(i);
+                    processSaturation(L[i], iirMidRollerL, iirLowCutoffL, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, antialias, true);
+                    processSaturation(R[i], iirMidRollerR, iirLowCutoffR, iirMidFreq, iirSubFreq, headBumpMix, headBumpDrive, antialias, false);
+                }
+
+                // Tape Hiss
+                if (hissLevel > 0.0)
+                {
+                    hissNoise.fillNoise(randomL.data(), randomR.data(), n);
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const auto index = static_cast<size_t>(i);
+                        L[i] = hissL.process(L[i], randomL[index], hissLevel, hissShape, hissFollow);
+                        R[i] = hissR.process(R[i], randomR[index], hissLevel, hissShape, hissFollow);
+                    }
+                }
 
                 // E. Decode (De-emphasis)
-                compDecodeL.process(L, dublyDecodeAmount, iirDecFreq, true);
-                compDecodeR.process(R, dublyDecodeAmount, iirDecFreq, true);
+                if (companderFade.remaining > 0)
+                {
+                    alignas(64) std::array<double, maxSubBlockSize> fromL;
+                    alignas(64) std::array<double, maxSubBlockSize> fromR;
+                    std::copy_n(L, n, fromL.data());
+                    std::copy_n(R, n, fromR.data());
+
+                    processDecode(companderFade.from, fromL.data(), fromR.data(), n, dublyDecodeAmount, iirDecFreq);
+                    processDecode(runningCompander, L, R, n, dublyDecodeAmount, iirDecFreq);
+                    companderFade.blend(L, R, fromL.data(), fromR.data(), n);
+                }
+
+                else
+                {
+                    processDecode(runningCompander, L, R, n, dublyDecodeAmount, iirDecFreq);
+                }
 
                 // Output Gain
-                if (outputGain != 1.0)
+                if (c.gainsRamping)
                 {
-                    L *= outputGain; R *= outputGain;
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const double gain = rampAt(c.outputRamp, c, offset + i);
+                        L[i] *= gain; R[i] *= gain;
+                    }
+                }
+
+                else if (outputGain != 1.0)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        L[i] *= outputGain; R[i] *= outputGain;
+                    }
                 }
 
                 // F. Soft Clipper
-                processSoftClip(L, lastSampleL, wasPosClipL, wasNegClipL);
-                processSoftClip(R, lastSampleR, wasPosClipR, wasNegClipR);
+                for (int i = 0; i < n; ++i)
+                {
+                    if (fading) qualityFade.moveTo(i);
+
+                    if (antialias == AntialiasMode::off)
+                    {
+                        clipShaperL.track(L[i]);
+                        clipShaperR.track(R[i]);
+                        processSoftClip(L[i], lastSampleL, wasPosClipL, wasNegClipL);
+                        processSoftClip(R[i], lastSampleR, wasPosClipR, wasNegClipR);
+                    }
+
+                    else
+                    {
+                        processAntialiasedClip(L[i], clipShaperL, lastSampleL, wasPosClipL, wasNegClipL, antialias);
+                        processAntialiasedClip(R[i], clipShaperR, lastSampleR, wasPosClipR, wasNegClipR, antialias);
+                    }
+
+                    outL[offset + i] = static_cast<SampleType>(L[i]);
+                    outR[offset + i] = static_cast<SampleType>(R[i]);
+                }
 
-                outL[i] = static_cast<float>(L);
-                outR[i] = static_cast<float>(R);
+                if (fading)
+                    qualityFade.remaining = std::max(0, qualityFade.remaining - n);
+
+                companderFade.remaining = std::max(0, companderFade.remaining - n);
             }
+
+            rampPosition += numSamples;
         }
 
+        // Update interval of the multi-rate compander in samples, before the
+        // quality level scales it; the mode itself is the Compander parameter.
+        // Call while stopped.
+        void setCompanderDecimation(int decimation) noexcept
+        {
+            companderDecimation = decimation;
+            updateCompander();
+        }
+
+        // The compander running now, which the quality level may have changed
+        // from the chosen one
+        CompanderMode getCompanderMode() const noexcept { return runningCompander; }
+
+        FlutterMode getFlutterMode() const noexcept { return flutterMode; }
+
+        // The baked SaturationTables shape the saturation curves when
+        // antialiasing is off; direct sin/cos is kept to compare against. The
+        // two differ by under 1e-9, so switching needs no crossfade.
+        void setSaturationMode(SaturationMode newMode) noexcept { saturationMode = newMode; }
+
+        SaturationMode getSaturationMode() const noexcept { return saturationMode; }
+
+        // Caps the flutter interpolation, antialiasing order, Jiles-Atherton
+        // solver and compander update rate (see qualityLevels). Takes effect at
+        // the next applyControls, with the audible switches crossfaded.
+        void setQualityLevel(int newLevel) noexcept
+        {
+            qualityLevel = juce::jlimit(0, numQualityLevels - 1, newLevel);
+            updateCompander();
+        }
+
+        int getQualityLevel() const noexcept { return qualityLevel; }
+
+        // Parts of the recursive state that recoverNonFinite checks and resets
+        // on their own, in signal order
+        enum StatePart : uint32_t
+        {
+            encodeState          = 1u << 0,     // per-sample compander, encode
+            multiRateEncodeState = 1u << 1,
+            flutterDelayState    = 1u << 2,
+            hysteresisState      = 1u << 3,
+            jilesAthertonState   = 1u << 4,
+            crossoverState       = 1u << 5,
+            lowsShaperState      = 1u << 6,
+            highsShaperState     = 1u << 7,
+            headBumpState        = 1u << 8,
+            hissState            = 1u << 9,
+            decodeState          = 1u << 10,    // per-sample compander, decode
+            multiRateDecodeState = 1u << 11,
+            clipperState         = 1u << 12,
+            clipShaperState      = 1u << 13
+        };
+
+        // After a block that came out non-finite: resets whichever parts of the
+        // recursive state hold NaN or Inf and leaves the rest, coefficients
+        // included, as they were. Returns the StatePart bits of what it reset,
+        // 0 if nothing needed resetting. Allocates nothing; safe on the audio
+        // thread.
+        uint32_t recoverNonFinite() noexcept
+        {
+            uint32_t recovered = 0;
+
+            auto repair = [&recovered](StatePart part, bool finite, auto&& reset)
+            {
+                if (! finite)
+                {
+                    reset();
+                    recovered |= part;
+                }
+            };
+
+            repair(encodeState, compEncodeL.isFinite() && compEncodeR.isFinite(), [this] { compEncodeL = CompanderBand(); compEncodeR = CompanderBand(); });
+            repair(multiRateEncodeState, multiRateEncode.isFinite(), [this] { multiRateEncode.reset(); });
+            repair(flutterDelayState, flutterDelay == nullptr || flutterDelay->isFinite(), [this] { flutterDelay->clear(); });
+
+            repair(hysteresisState, hysteresis.isFinite(), [this] { hysteresis.resetState(); });
+            repair(jilesAthertonState, jilesAtherton.isFinite(), [this] { jilesAtherton.reset(); });
+
+            repair(crossoverState, allFinite(iirMidRollerL, iirMidRollerR, iirLowCutoffL, iirLowCutoffR),
+                   [this] { iirMidRollerL = iirMidRollerR = iirLowCutoffL = iirLowCutoffR = 0.0; });
+
+            repair(lowsShaperState, lowsShaperL.isFinite() && lowsShaperR.isFinite(), [this] { lowsShaperL.reset(); lowsShaperR.reset(); });
+            repair(highsShaperState, highsShaperL.isFinite() && highsShaperR.isFinite(), [this] { highsShaperL.reset(); highsShaperR.reset(); });
+
+            // The head bump's cubic feedback is the usual runaway
+            repair(headBumpState, allFinite(headBumpAccL, headBumpAccR) && bumpFilterA.isFinite() && bumpFilterB.isFinite(),
+                   [this] { headBumpAccL = headBumpAccR = 0.0; bumpFilterA.resetState(); bumpFilterB.resetState(); });
+
+            repair(hissState, hissL.isFinite() && hissR.isFinite(), [this] { hissL = TapeHiss(); hissR = TapeHiss(); });
+
+            repair(decodeState, compDecodeL.isFinite() && compDecodeR.isFinite(), [this] { compDecodeL = CompanderBand(); compDecodeR = CompanderBand(); });
+            repair(multiRateDecodeState, multiRateDecode.isFinite(), [this] { multiRateDecode.reset(); });
+
+            repair(clipperState, allFinite(lastSampleL, lastSampleR), [this]
+            {
+                lastSampleL = lastSampleR = 0.0;
+                wasPosClipL = wasNegClipL = wasPosClipR = wasNegClipR = false;
+            });
+
+            repair(clipShaperState, clipShaperL.isFinite() && clipShaperR.isFinite(), [this] { clipShaperL.reset(); clipShaperR.reset(); });
+
+            return recovered;
+        }
+
+        // For containment tests: leaves NaN in the left channel of one part of
+        // the state, as a block that ran away inside the engine would. Some
+        // parts get over it on their own: the clipper overwrites its memory
+        // every sample and Jiles-Atherton restarts a lane whose step is not
+        // finite.
+        void poisonState(StatePart part) noexcept
+        {
+            constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+            auto poisonLane = [nan](MultiRateCompander& compander)
+            {
+                auto left = compander.getLaneState(0);
+                left.iirFilter = nan;
+                compander.setLaneStates(left, compander.getLaneState(1));
+            };
+
+            switch (part)
+            {
+                case encodeState:           compEncodeL.iirFilter = nan; break;
+                case multiRateEncodeState:  poisonLane(multiRateEncode); break;
+                case flutterDelayState:     if (flutterDelay != nullptr) std::fill_n(flutterDelay->left, FlutterDelay::size, nan); break;
+                case hysteresisState:       hysteresis.poisonState(); break;
+                case jilesAthertonState:    jilesAtherton.poisonState(); break;
+                case crossoverState:        iirMidRollerL = nan; break;
+                case lowsShaperState:       lowsShaperL.track(nan); break;
+                case highsShaperState:      highsShaperL.track(nan); break;
+                case headBumpState:         headBumpAccL = nan; break;
+                case hissState:             hissL.envelope = nan; break;
+                case decodeState:           compDecodeL.iirFilter = nan; break;
+                case multiRateDecodeState:  poisonLane(multiRateDecode); break;
+                case clipperState:          lastSampleL = nan; break;
+                case clipShaperState:       clipShaperL.track(nan); break;
+                default:                    break;
+            }
+        }
+
+        // Left flutter delay read offset after the last sub-block, in samples
+        // ahead of the write position; for analysis only
+        double getFlutterOffset() const noexcept { return flutterOffset; }
+
     private:
 
-        double sampleRate = 44100.0;
-        RandomGenerator rngL, rngR;
+        // Per-block coefficients derived from the smoothed parameters
+        struct BlockParameters
+        {
+            double inputGain = 1.0, outputGain = 1.0;
+            double dublyEncodeAmount = 0.0, dublyDecodeAmount = 0.0;
+            double iirEncFreq = 0.0, iirDecFreq = 0.0, iirMidFreq = 0.0, iirSubFreq = 0.0;
+            double flutterDepth = 0.0, flutterSpeed = 0.0;
+            double headBumpMix = 0.0, headBumpDrive = 0.0;
+            double hissLevel = 0.0, hissShape = 0.0, hissFollow = 0.0;
+            AntialiasMode antialias = AntialiasMode::off;
+            int interpolationPoints = qualityLevels[0].interpolationPoints;
+            bool jilesAtherton = false;
+        };
 
-        // Transport State
-        double delayL[1002] = {0};
-        double delayR[1002] = {0};
-        int writeIndex = 0;
-        double sweepL = 3.14159, sweepR = 3.14159;
-        double nextMaxL = 0.5, nextMaxR = 0.5;
+        // Settings in effect before the last quality or antialiasing change,
+        // faded out over remaining samples; mix is the new settings' share at
+        // the sample being processed
+        struct QualityFade
+        {
+            int length = 1, remaining = 0;
+            int interpolationPoints = qualityLevels[0].interpolationPoints;
+            AntialiasMode antialias = AntialiasMode::off;
+            double mix = 1.0;
+
+            void moveTo(int index) noexcept
+            {
+                mix = std::min(1.0, 1.0 - (static_cast<double>(remaining - index) / static_cast<double>(length)));
+            }
+        };
+
+        // After a compander switch the one switched from keeps running, from
+        // its own state, and its output is faded out over remaining samples
+        struct CompanderFade
+        {
+            int length = 1, remaining = 0;
+            CompanderMode from = CompanderMode::perSample;
+
+            void blend(double* L, double* R, const double* fromL, const double* fromR, int n) const noexcept
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    const double mix = std::min(1.0, 1.0 - (static_cast<double>(remaining - i) / static_cast<double>(length)));
+                    L[i] = fromL[i] + ((L[i] - fromL[i]) * mix);
+                    R[i] = fromR[i] + ((R[i] - fromR[i]) * mix);
+                }
+            }
+        };
+
+        // Flutter delay read offsets of the last sample, and after a flutter
+        // mode change the glide from them onto the new mode's offsets
+        struct OffsetGlide
+        {
+            double lastL = 0.0, lastR = 0.0;
+            double fromL = 0.0, fromR = 0.0;
+            int length = 1, remaining = 0;
+
+            void apply(double& offsetL, double& offsetR) noexcept
+            {
+                if (remaining > 0)
+                {
+                    const double share = static_cast<double>(remaining--) / static_cast<double>(length);
+                    offsetL += (fromL - offsetL) * share;
+                    offsetR += (fromR - offsetR) * share;
+                }
+
+                lastL = offsetL;
+                lastR = offsetR;
+            }
+        };
+
+        // ---- Hot: read or written every sample ----
+        BlockParameters blockParameters;
+        QualityFade qualityFade;
 
         // Saturation State
         double iirMidRollerL = 0, iirMidRollerR = 0;
@@ -348,16 +1133,247 @@ namespace MarsDSP::DSP {
         double headBumpAccL = 0, headBumpAccR = 0;
         Biquad bumpFilterA, bumpFilterB;
 
+        // Clipper State
+        double lastSampleL = 0, lastSampleR = 0;
+        bool wasPosClipL = false, wasNegClipL = false, wasPosClipR = false, wasNegClipR = false;
+
+        // Transport State
+        int writeIndex = 0;
+        double sweepL = 3.14159, sweepR = 3.14159;
+        double nextMaxL = 0.5, nextMaxR = 0.5;
+        double flutterOffset = 0.0;
+        FlutterDelay* flutterDelay = nullptr;
+        FlutterMode flutterMode = FlutterMode::classic;
+        OffsetGlide offsetGlide;
+        CompanderFade companderFade;
+        SaturationMode saturationMode = SaturationMode::table;
+        TransportModulation transport;
+
         // Helper Classes instances
         HysteresisProcessor hysteresis;
+        JilesAthertonHysteresis jilesAtherton;
+        TapeHiss hissL, hissR;
         CompanderBand compEncodeL, compEncodeR, compDecodeL, compDecodeR;
+        CompanderMode companderMode = CompanderMode::perSample, runningCompander = CompanderMode::perSample;
+        MultiRateCompander multiRateEncode { false }, multiRateDecode { true };
+        int companderDecimation = 8;
 
-        // Clipper State
-        double lastSampleL = 0, lastSampleR = 0;
-        bool wasPosClipL = false, wasNegClipL = false, wasPosClipR = false, wasNegClipR = false;
+        // Antialiased (ADAA) curve state
+        ADAAProcessor<SineSaturationCurve> lowsShaperL, lowsShaperR;
+        ADAAProcessor<CosineThinningCurve> highsShaperL, highsShaperR;
+        ADAAProcessor<HardClipCurve> clipShaperL, clipShaperR;
+
+        // ---- Cold: per block or less ----
+        double sampleRate = 44100.0;
+
+        // Samples processed since the last applyControls, to index the ramps
+        int rampPosition = 0;
+
+        int qualityLevel = 0;
+        bool hasControls = false;
+
+        static constexpr double qualityFadeSeconds = 0.005;
+
+        void beginQualityFade() noexcept
+        {
+            qualityFade.interpolationPoints = blockParameters.interpolationPoints;
+            qualityFade.antialias = blockParameters.antialias;
+            qualityFade.length = std::max(1, static_cast<int>(qualityFadeSeconds * sampleRate));
+            qualityFade.remaining = qualityFade.length;
+        }
+
+        // The two flutter modes put the read offset in different places, so the
+        // new mode's offsets are glided onto from the old one's over the
+        // quality fade time rather than jumped to
+        void switchFlutterMode(FlutterMode newMode) noexcept
+        {
+            transport.reset();
+
+            if (hasControls && blockParameters.flutterDepth > 0.0)
+            {
+                offsetGlide.fromL = offsetGlide.lastL;
+                offsetGlide.fromR = offsetGlide.lastR;
+                offsetGlide.length = std::max(1, static_cast<int>(qualityFadeSeconds * sampleRate));
+                offsetGlide.remaining = offsetGlide.length;
+            }
+
+            flutterMode = newMode;
+        }
+
+        void processEncode(CompanderMode mode, double* L, double* R, int n, double amount, double frequency) noexcept
+        {
+            if (mode == CompanderMode::multiRate)
+            {
+                multiRateEncode.process(L, R, n, amount, frequency);
+                return;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                compEncodeL.process(L[i], amount, frequency, false);
+                compEncodeR.process(R[i], amount, frequency, false);
+            }
+        }
+
+        void processDecode(CompanderMode mode, double* L, double* R, int n, double amount, double frequency) noexcept
+        {
+            if (mode == CompanderMode::multiRate)
+            {
+                multiRateDecode.process(L, R, n, amount, frequency);
+                return;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                compDecodeL.process(L[i], amount, frequency, true);
+                compDecodeR.process(R[i], amount, frequency, true);
+            }
+        }
+
+        // Moves the encode and decode stages between the per-sample
+        // CompanderBands and the MultiRateCompanders, handing the filter, level
+        // and gain state across so the switch does not restart the detectors.
+        // The two still differ in how often they update the gain, so the old
+        // one's output is crossfaded out over the quality fade time.
+        void switchCompander(CompanderMode newMode) noexcept
+        {
+            if (hasControls)
+            {
+                companderFade.from = runningCompander;
+                companderFade.length = std::max(1, static_cast<int>(qualityFadeSeconds * sampleRate));
+                companderFade.remaining = companderFade.length;
+            }
+
+            auto toLane = [](const CompanderBand& band) { return MultiRateCompander::LaneState { band.iirFilter, band.avgLevel, band.compGain }; };
+            auto toBand = [](const MultiRateCompander::LaneState& lane) { return CompanderBand { lane.iirFilter, lane.gain, lane.avgLevel }; };
+
+            if (newMode == CompanderMode::multiRate)
+            {
+                multiRateEncode.setLaneStates(toLane(compEncodeL), toLane(compEncodeR));
+                multiRateDecode.setLaneStates(toLane(compDecodeL), toLane(compDecodeR));
+            }
+
+            else
+            {
+                compEncodeL = toBand(multiRateEncode.getLaneState(0));
+                compEncodeR = toBand(multiRateEncode.getLaneState(1));
+                compDecodeL = toBand(multiRateDecode.getLaneState(0));
+                compDecodeR = toBand(multiRateDecode.getLaneState(1));
+            }
+
+            runningCompander = newMode;
+        }
+
+        // Runs the compander the user chose, scale times less often if it is
+        // the multi-rate one, unless the quality level drops the per-sample
+        // bands: then the multi-rate one runs either way, every scale samples
+        void updateCompander() noexcept
+        {
+            const auto& quality = qualityLevels[static_cast<size_t>(qualityLevel)];
+            const int scale = quality.companderDecimationScale;
+            const bool chosen = companderMode == CompanderMode::multiRate;
+            const auto running = chosen || ! quality.perSampleCompander ? CompanderMode::multiRate : CompanderMode::perSample;
+            const int decimation = chosen ? companderDecimation * scale : scale;
+
+            if (running != runningCompander)
+                switchCompander(running);
+
+            if (multiRateEncode.getDecimation() != decimation)
+            {
+                multiRateEncode.setDecimation(decimation);
+                multiRateDecode.setDecimation(decimation);
+            }
+        }
+
+        double rampAt(const std::array<float, maxSubBlockSize>& ramp, const ControlValues& c, int index) const noexcept
+        {
+            return ramp[static_cast<size_t>(std::min(rampPosition + index, c.rampLength - 1))];
+        }
+
+        // Every random number of the engine, one stream per use so each
+        // stays independent of the block size: denormal dither, hiss, and the
+        // classic flutter's cycle lengths
+        NoiseGenerator ditherNoise, hissNoise, flutterNoise;
+
+        TapeStateArena* arena = &TapeStateArena::getShared();
+        bool isRegistered = false;
+        int flutterIdleSamples = 0;
+
+        // Binds a delay slab while flutter is active and hands it back after a
+        // second of inactivity. Returns whether a slab is bound.
+        bool updateFlutterDelay(bool active, int numSamples) noexcept
+        {
+            if (active)
+            {
+                flutterIdleSamples = 0;
+
+                if (flutterDelay == nullptr)
+                {
+                    flutterDelay = arena->tryAcquire();
+
+                    if (flutterDelay != nullptr)
+                    {
+                        flutterDelay->clear();
+                        writeIndex = 0;
+                    }
+                }
+
+                return flutterDelay != nullptr;
+            }
+
+            if (flutterDelay != nullptr)
+            {
+                flutterIdleSamples += numSamples;
+
+                if (flutterIdleSamples >= static_cast<int>(sampleRate) && arena->tryRelease(flutterDelay))
+                    flutterDelay = nullptr;
+            }
+
+            return false;
+        }
+
+        // Flutter delay read at the current quality level's interpolation order,
+        // blended with the previous order while a quality change is crossfaded
+        double readDelay(double* buffer, int baseIndex, double frac) const noexcept
+        {
+            const int points = blockParameters.interpolationPoints;
+            const double y = interpolateDelay(buffer, baseIndex, frac, points);
+
+            if (qualityFade.remaining <= 0 || qualityFade.interpolationPoints == points)
+                return y;
+
+            const double previous = interpolateDelay(buffer, baseIndex, frac, qualityFade.interpolationPoints);
+            return previous + ((y - previous) * qualityFade.mix);
+        }
+
+        // 6 points: 5th order Lagrange; 4 points: cubic Lagrange; 2 points: linear
+        static double interpolateDelay(double* buffer, int baseIndex, double frac, int points) noexcept
+        {
+            auto get = [&](int offset)
+            {
+                return buffer[(baseIndex + offset + 10000) % 1000];
+            };
+
+            if (points == 2)
+                return get(0) + ((get(1) - get(0)) * frac);
+
+            if (points == 4)
+            {
+                const double d_1 = frac + 1.0;
+                const double d1  = frac - 1.0;
+                const double d2  = frac - 2.0;
+
+                return (get(-1) * (frac * d1 * d2) * -0.16666666666666667) +
+                       (get(0)  * (d_1 * d1 * d2) * 0.5) +
+                       (get(1)  * (d_1 * frac * d2) * -0.5) +
+                       (get(2)  * (d_1 * frac * d1) * 0.16666666666666667);
+            }
+
+            return getLagrangeSample(buffer, baseIndex, frac);
+        }
 
         // Lagrange 5th Interpolation for flutter
-        double getLagrangeSample(double* buffer, int baseIndex, double frac)
+        static double getLagrangeSample(double* buffer, int baseIndex, double frac) noexcept
         {
              double d_2 = frac + 2.0;
              double d_1 = frac + 1.0;
@@ -388,29 +1404,20 @@ namespace MarsDSP::DSP {
 
         void processFlutter(double& L, double& R, double depth, double speed)
         {
-            if (writeIndex < 0 || writeIndex > 999)
-                writeIndex = 0;
-
-            delayL[writeIndex] = L;
-            delayR[writeIndex] = R;
-            
             // Calculate Read Position L
             double offsetL = depth + (depth * std::sin(sweepL));
             sweepL += nextMaxL * speed;
             if (sweepL > 6.2831853)
             {
                 sweepL -= 6.2831853;
-                double flutA = 0.24 + (rngL.nextDouble() * 0.74);
-                double flutB = 0.24 + (rngL.nextDouble() * 0.74);
+                std::array<float, 2> draws;
+                flutterNoise.fillUniform(draws.data(), 2);
+                double flutA = 0.24 + (draws[0] * 0.74);
+                double flutB = 0.24 + (draws[1] * 0.74);
 
                 // Scrape flutter logic
                 nextMaxL = (std::abs(flutA - std::sin(sweepR + nextMaxR)) < std::abs(flutB - std::sin(sweepR + nextMaxR))) ? flutA : flutB;
             }
-            
-            // Interpolation L
-            int count = writeIndex + static_cast<int>(std::floor(offsetL));
-            double frac = offsetL - std::floor(offsetL);
-            L = getLagrangeSample(delayL, count, frac);
 
             // Calculate Read Position R
             double offsetR = depth + (depth * std::sin(sweepR));
@@ -418,22 +1425,39 @@ namespace MarsDSP::DSP {
             if (sweepR > 6.2831853)
             {
                 sweepR -= 6.2831853;
-                double flutA = 0.24 + (rngR.nextDouble() * 0.74);
-                double flutB = 0.24 + (rngR.nextDouble() * 0.74);
+                std::array<float, 2> draws;
+                flutterNoise.fillUniform(draws.data(), 2);
+                double flutA = 0.24 + (draws[0] * 0.74);
+                double flutB = 0.24 + (draws[1] * 0.74);
 
                 // Scrape flutter logic
                 nextMaxR = (std::abs(flutA - std::sin(sweepL + nextMaxL)) < std::abs(flutB - std::sin(sweepL + nextMaxL))) ? flutA : flutB;
             }
 
-            // Interpolation R
-            count = writeIndex + static_cast<int>(std::floor(offsetR));
-            frac = offsetR - std::floor(offsetR);
-            R = getLagrangeSample(delayR, count, frac);
-            
-            writeIndex++; // Increment global buffer index
+            processModulatedDelay(L, R, offsetL, offsetR);
         }
 
-        void processSaturation(double& sample, double& midRoller, double& lowCutoff, double midFreq, double subFreq, double bumpMix, double bumpDrive, bool isLeft)
+        // Writes the flutter delay and reads it back at the given offsets, from
+        // the classic sweep or generated a block at a time by TransportModulation
+        void processModulatedDelay(double& L, double& R, double offsetL, double offsetR)
+        {
+            if (writeIndex < 0 || writeIndex > 999)
+                writeIndex = 0;
+
+            flutterDelay->left[writeIndex] = L;
+            flutterDelay->right[writeIndex] = R;
+
+            offsetGlide.apply(offsetL, offsetR);
+
+            const double wholeL = std::floor(offsetL);
+            const double wholeR = std::floor(offsetR);
+            L = readDelay(flutterDelay->left, writeIndex + static_cast<int>(wholeL), offsetL - wholeL);
+            R = readDelay(flutterDelay->right, writeIndex + static_cast<int>(wholeR), offsetR - wholeR);
+
+            writeIndex++;
+        }
+
+        void processSaturation(double& sample, double& midRoller, double& lowCutoff, double midFreq, double subFreq, double bumpMix, double bumpDrive, AntialiasMode antialias, bool isLeft)
         {
             // Crossover
             midRoller = (midRoller * (1.0 - midFreq)) + (sample * midFreq);
@@ -446,27 +1470,50 @@ namespace MarsDSP::DSP {
                 lows -= lowCutoff;
             }
 
-            // Saturation Curves
-            // Lows: Sine saturation (analog warmth)
-            if (lows > 1.570796)
-                lows = 1.570796;
+            auto& lowsShaper = isLeft ? lowsShaperL : lowsShaperR;
+            auto& highsShaper = isLeft ? highsShaperL : highsShaperR;
+
+            if (qualityFade.remaining > 0 && qualityFade.antialias != antialias)
+            {
+                // Both orders from the same history while the change is crossfaded
+                lows = lowsShaper.processBlend(lows, qualityFade.antialias, antialias, qualityFade.mix);
+                highs = highsShaper.processBlend(highs, qualityFade.antialias, antialias, qualityFade.mix);
+            }
+
+            else if (antialias != AntialiasMode::off)
+            {
+                // Same curves as below, evaluated through their antiderivatives
+                lows = lowsShaper.process(lows, antialias);
+                highs = highsShaper.process(highs, antialias);
+            }
+
+            else
+            {
+                lowsShaper.track(lows);
+                highsShaper.track(highs);
+
+                // Saturation Curves
+                // Lows: Sine saturation (analog warmth)
+                if (lows > 1.570796)
+                    lows = 1.570796;
 
-            if (lows < -1.570796)
-                lows = -1.570796;
+                if (lows < -1.570796)
+                    lows = -1.570796;
 
-            lows = std::sin(lows);
+                lows = std::sin(lows);
 
-            // Highs: Cosine saturation (tape compression)
-            double thinned = std::abs(highs) * 1.570796;
+                // Highs: Cosine saturation (tape compression)
+                double thinned = std::abs(highs) * 1.570796;
 
-            if (thinned > 1.570796)
-                thinned = 1.570796;
+                if (thinned > 1.570796)
+                    thinned = 1.570796;
 
-            thinned = 1.0 - std::cos(thinned);
+                thinned = 1.0 - std::cos(thinned);
 
-            if (highs < 0)
-                thinned = -thinned;
-            highs -= thinned;
+                if (highs < 0)
+                    thinned = -thinned;
+                highs -= thinned;
+            }
 
             // Head Bump Application
             if (bumpMix > 0.0)
@@ -500,6 +1547,102 @@ namespace MarsDSP::DSP {
             }
         }
         
+        // processSaturation without antialiasing, a sub-block of one channel at
+        // a time: the crossover runs first, so the curves are applied from the
+        // tables in loops of their own
+        void processSaturationBlock(double* samples, int numSamples, double& midRoller, double& lowCutoff, double midFreq, double subFreq, double bumpMix, double bumpDrive, bool isLeft)
+        {
+            alignas(64) std::array<double, maxSubBlockSize> lows;
+            alignas(64) std::array<double, maxSubBlockSize> highs;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto index = static_cast<size_t>(i);
+                midRoller = (midRoller * (1.0 - midFreq)) + (samples[i] * midFreq);
+                highs[index] = samples[i] - midRoller;
+                lows[index] = midRoller;
+
+                if (subFreq > 0.0)
+                {
+                    lowCutoff = (lowCutoff * (1.0 - subFreq)) + (lows[index] * subFreq);
+                    lows[index] -= lowCutoff;
+                }
+            }
+
+            // Keep the antialiased paths primed, as the per-sample path does
+            auto& lowsShaper = isLeft ? lowsShaperL : lowsShaperR;
+            auto& highsShaper = isLeft ? highsShaperL : highsShaperR;
+
+            for (int i = std::max(0, numSamples - 2); i < numSamples; ++i)
+            {
+                lowsShaper.track(lows[static_cast<size_t>(i)]);
+                highsShaper.track(highs[static_cast<size_t>(i)]);
+            }
+
+            const auto& tables = SaturationTables::get();
+            tables.shapeLows(lows.data(), numSamples);
+            tables.thinHighs(highs.data(), numSamples);
+
+            if (bumpMix > 0.0)
+            {
+                double& hbAcc = isLeft ? headBumpAccL : headBumpAccR;
+                const double bumpSaturation = 0.0618 / std::sqrt(sampleRate / 44100.0);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const auto index = static_cast<size_t>(i);
+
+                    // Same bump as processSaturation
+                    hbAcc += (lows[index] * bumpDrive);
+                    hbAcc -= (std::pow(hbAcc, 3) * bumpSaturation);
+
+                    double processedBump = hbAcc;
+                    if (isLeft)
+                    {
+                        bumpFilterA.processL(processedBump);
+                        bumpFilterB.processL(processedBump);
+                    }
+
+                    else
+                    {
+                        bumpFilterA.processR(processedBump);
+                        bumpFilterB.processR(processedBump);
+                    }
+
+                    samples[i] = lows[index] + highs[index] + (processedBump * bumpMix);
+                }
+            }
+
+            else
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    samples[i] = lows[static_cast<size_t>(i)] + highs[static_cast<size_t>(i)];
+            }
+        }
+
+        // The stateful clipper cannot be integrated, so the antialiased modes clip
+        // at the same ceiling through ADAA instead. Its state is kept primed with
+        // the clamped input so switching back to Off is seamless.
+        void processAntialiasedClip(double& sample, ADAAProcessor<HardClipCurve>& shaper, double& lastSample, bool& wasPos, bool& wasNeg, AntialiasMode antialias)
+        {
+            if (sample > 4.0)
+                sample = 4.0;
+
+            if (sample < -4.0)
+                sample = -4.0;
+
+            lastSample = sample;
+            wasPos = false;
+            wasNeg = false;
+
+            // Between two antialiased orders the clip is crossfaded like the
+            // saturation; to and from Off it switches, primed as above
+            if (qualityFade.remaining > 0 && qualityFade.antialias != antialias && qualityFade.antialias != AntialiasMode::off)
+                sample = shaper.processBlend(sample, qualityFade.antialias, antialias, qualityFade.mix);
+            else
+                sample = shaper.process(sample, antialias);
+        }
+
         void processSoftClip(double& sample, double& lastSample, bool& wasPos, bool& wasNeg)
         {
              if (sample > 4.0)
@@ -539,5 +1682,7 @@ namespace MarsDSP::DSP {
              sample = lastSample;
              lastSample = temp;
         }
+
+        JUCE_DECLARE_NON_COPYABLE(TapeDSP)
     };
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "SignalGuard.h"
+#include <mutex>
+#include <new>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // COLD STATE ARENA
+    // ==============================================================================
+    //
+    // TapeDSP keeps only its per-sample state inline; the ~16 KB of flutter delay
+    // memory lives in slabs handed out by an arena shared between instances. A
+    // slab is only bound while flutter is active, so an instance with flutter off
+    // touches its inline state alone.
+    //
+    // Capacity is grown off the audio thread (registerClient, one slab per
+    // prepared engine). acquire/release only ever try the lock, so the audio
+    // thread never blocks: on contention the caller simply retries next block.
+
+    struct alignas(64) FlutterDelay
+    {
+        static constexpr int size = 1002;
+
+        double left[size];
+        double right[size];
+
+        void clear() noexcept
+        {
+            std::fill(std::begin(left), std::end(left), 0.0);
+            std::fill(std::begin(right), std::end(right), 0.0);
+        }
+
+        // Scans the whole slab; for recovery after a fault, not per block
+        bool isFinite() const noexcept { return allFiniteIn(left) && allFiniteIn(right); }
+    };
+
+    class TapeStateArena
+    {
+    public:
+
+        TapeStateArena() = default;
+
+        ~TapeStateArena()
+        {
+            for (auto* chunk : chunks)
+                ::operator delete(chunk, std::align_val_t { alignof(FlutterDelay) });
+        }
+
+        // Message thread: makes room for one more engine. Slabs are allocated
+        // uninitialised in chunks, so pages are only committed once used.
+        void registerClient()
+        {
+            const std::lock_guard<std::mutex> growLock(growMutex);
+
+            ++numClients;
+
+            if (numClients <= totalSlabs)
+                return;
+
+            auto* chunk = static_cast<FlutterDelay*>(::operator new(sizeof(FlutterDelay) * slabsPerChunk,
+                                                                    std::align_val_t { alignof(FlutterDelay) }));
+
+            std::vector<FlutterDelay*> grown;
+            grown.reserve(static_cast<size_t>(totalSlabs + slabsPerChunk));
+
+            const juce::SpinLock::ScopedLockType lock(freeListLock);
+
+            grown.assign(freeList.begin(), freeList.end());
+            for (int i = 0; i < slabsPerChunk; ++i)
+                grown.push_back(chunk + i);
+
+            freeList.swap(grown);
+            chunks.push_back(chunk);
+            totalSlabs += slabsPerChunk;
+        }
+
+        void unregisterClient()
+        {
+            const std::lock_guard<std::mutex> growLock(growMutex);
+            jassert(numClients > 0);
+            --numClients;
+        }
+
+        // Audio thread safe; nullptr if the lock is busy or the arena is empty
+        FlutterDelay* tryAcquire() noexcept
+        {
+            const juce::SpinLock::ScopedTryLockType lock(freeListLock);
+
+            if (! lock.isLocked() || freeList.empty())
+                return nullptr;
+
+            auto* slab = freeList.back();
+            freeList.pop_back();
+            return slab;
+        }
+
+        // Audio thread safe; false if the lock is busy (keep the slab and retry)
+        bool tryRelease(FlutterDelay* slab) noexcept
+        {
+            const juce::SpinLock::ScopedTryLockType lock(freeListLock);
+
+            if (! lock.isLocked())
+                return false;
+
+            // Capacity always covers every slab, so this never allocates
+            freeList.push_back(slab);
+            return true;
+        }
+
+        // Blocking release for destructors and prepare, never the audio thread
+        void release(FlutterDelay* slab) noexcept
+        {
+            const juce::SpinLock::ScopedLockType lock(freeListLock);
+            freeList.push_back(slab);
+        }
+
+        // Arena shared by every engine in this binary
+        static TapeStateArena& getShared()
+        {
+            static TapeStateArena shared;
+            return shared;
+        }
+
+    private:
+
+        static constexpr int slabsPerChunk = 16;
+
+        std::mutex growMutex;
+        int numClients = 0;
+        int totalSlabs = 0;
+        std::vector<FlutterDelay*> chunks;
+
+        juce::SpinLock freeListLock;
+        std::vector<FlutterDelay*> freeList;
+
+        JUCE_DECLARE_NON_COPYABLE(TapeStateArena)
+    };
+}
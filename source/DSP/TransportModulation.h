@@ -0,0 +1,216 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include <array>
+#include <cmath>
+
+namespace MarsDSP::DSP {
+
+    // ==============================================================================
+    // TRANSPORT MODULATION
+    // ==============================================================================
+    //
+    // Wavetable alternative to the single per-sample sine of the classic flutter.
+    // Three components are summed into the delay-time modulation:
+    //   wow     - slow, irregular speed drift (reel eccentricity, tension)
+    //   flutter - capstan rotation with its low harmonics
+    //   scrape  - fast, noise-like modulation from the tape rubbing the heads
+    //
+    // Each component reads its own precomputed, periodic and band-limited table,
+    // so a whole sub-block of modulation costs a few table reads per sample and
+    // no transcendental calls. The right channel blends each table with its
+    // quadrature twin, which sets the stereo correlation exactly.
+
+    enum class FlutterMode
+    {
+        classic,
+        wavetable
+    };
+
+    // Sums of harmonics with fixed pseudo-random phases. Because every table holds
+    // whole cycles of its harmonics only, reading it at any rate stays band-limited
+    // to maxHarmonic * cycle rate. Each table has a quadrature twin with every
+    // harmonic shifted by a quarter cycle: the two are uncorrelated over a period,
+    // and both are scaled by the peak of their joint envelope, so any blend
+    // c * table + sqrt(1 - c^2) * quadrature stays within [-1, 1].
+    class ModulationWavetables
+    {
+    public:
+
+        static constexpr int size = 4096;
+
+        enum Table { wow, flutter, scrape, numTables };
+
+        static constexpr std::array<int, numTables> maxHarmonic { 8, 3, 256 };
+
+        ModulationWavetables() noexcept
+        {
+            uint32_t seed = 0x5EEDF00D;
+
+            auto nextPhase = [&seed]
+            {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                return juce::MathConstants<double>::twoPi * static_cast<double>(seed) / static_cast<double>(UINT32_MAX);
+            };
+
+            // Wow: pink-ish spectrum over the first harmonics, so cycles never look alike
+            fill(wow, [&](int harmonic) { return 1.0 / harmonic; }, 1, maxHarmonic[wow], nextPhase);
+
+            // Flutter: fundamental with a little second and third harmonic
+            fill(flutter, [](int harmonic) { return harmonic == 1 ? 1.0 : (harmonic == 2 ? 0.3 : 0.1); }, 1, maxHarmonic[flutter], nextPhase);
+
+            // Scrape: flat band of upper harmonics, i.e. band-limited noise
+            fill(scrape, [](int) { return 1.0; }, 32, maxHarmonic[scrape], nextPhase);
+        }
+
+        // Linear interpolation at phase in [0, 1)
+        double read(Table table, double phase) const noexcept
+        {
+            return interpolate(tables[static_cast<size_t>(table)], phase);
+        }
+
+        double readQuadrature(Table table, double phase) const noexcept
+        {
+            return interpolate(quadrature[static_cast<size_t>(table)], phase);
+        }
+
+        // Built on first use; ProcessBlock::prepareDSP touches it off the audio thread
+        static const ModulationWavetables& get() noexcept
+        {
+            static const ModulationWavetables instance;
+            return instance;
+        }
+
+    private:
+
+        using TableData = std::array<double, size + 1>;
+
+        static double interpolate(const TableData& data, double phase) noexcept
+        {
+            const double position = phase * size;
+            const int index = static_cast<int>(position);
+            const double frac = position - index;
+            return data[static_cast<size_t>(index)] + (frac * (data[static_cast<size_t>(index) + 1] - data[static_cast<size_t>(index)]));
+        }
+
+        template <typename Amplitude, typename Phase>
+        void fill(Table id, Amplitude&& amplitude, int firstHarmonic, int lastHarmonic, Phase&& nextPhase) noexcept
+        {
+            auto& table = tables[static_cast<size_t>(id)];
+            auto& twin = quadrature[static_cast<size_t>(id)];
+            table.fill(0.0);
+            twin.fill(0.0);
+
+            for (int harmonic = firstHarmonic; harmonic <= lastHarmonic; ++harmonic)
+            {
+                const double gain = amplitude(harmonic);
+                const double phase = nextPhase();
+
+                for (int i = 0; i < size; ++i)
+                {
+                    const double angle = (juce::MathConstants<double>::twoPi * harmonic * i / size) + phase;
+                    table[static_cast<size_t>(i)] += gain * std::sin(angle);
+                    twin[static_cast<size_t>(i)] += gain * std::cos(angle);
+                }
+            }
+
+            double peak = 0.0;
+            for (int i = 0; i < size; ++i)
+                peak = std::max(peak, std::hypot(table[static_cast<size_t>(i)], twin[static_cast<size_t>(i)]));
+
+            for (int i = 0; i < size; ++i)
+            {
+                table[static_cast<size_t>(i)] /= peak;
+                twin[static_cast<size_t>(i)] /= peak;
+            }
+
+            table[size] = table[0];
+            twin[size] = twin[0];
+        }
+
+        std::array<TableData, numTables> tables {}, quadrature {};
+    };
+
+    class TransportModulation
+    {
+    public:
+
+        // Component mix (normalised internally) and stereo correlation, 0 to 1
+        struct Settings
+        {
+            double wow = 0.6;
+            double flutter = 0.3;
+            double scrape = 0.1;
+            double correlation = 0.5;
+        };
+
+        void reset() noexcept
+        {
+            phase.fill(0.0);
+        }
+
+        void setSettings(const Settings& newSettings) noexcept
+        {
+            const double total = juce::jmax(1.0e-9, newSettings.wow + newSettings.flutter + newSettings.scrape);
+            weights = { newSettings.wow / total, newSettings.flutter / total, newSettings.scrape / total };
+
+            const double correlation = juce::jlimit(0.0, 1.0, newSettings.correlation);
+            rightShared = correlation;
+            rightQuadrature = std::sqrt(1.0 - (correlation * correlation));
+
+            settings = newSettings;
+        }
+
+        const Settings& getSettings() const noexcept { return settings; }
+
+        // Speed parameter (0 to 1) to component rates, in table cycles per sample
+        void updateRates(double speed, double sampleRate) noexcept
+        {
+            increment[ModulationWavetables::wow] = (0.3 + 1.2 * speed) / 8.0 / sampleRate;
+            increment[ModulationWavetables::flutter] = (4.0 + 12.0 * speed) / sampleRate;
+            increment[ModulationWavetables::scrape] = (2.0 + 6.0 * speed) / sampleRate;
+        }
+
+        // Read offsets in samples for the flutter delay, in [0, 2 * depth]
+        void generate(double* offsetL, double* offsetR, int numSamples, double depth) noexcept
+        {
+            const auto& tables = ModulationWavetables::get();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                offsetL[i] = depth;
+                offsetR[i] = depth;
+            }
+
+            for (int table = 0; table < ModulationWavetables::numTables; ++table)
+            {
+                const auto id = static_cast<ModulationWavetables::Table>(table);
+                const double gain = depth * weights[static_cast<size_t>(table)];
+                const double step = increment[static_cast<size_t>(table)];
+                double p = phase[static_cast<size_t>(table)];
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const double shared = tables.read(id, p);
+                    offsetL[i] += gain * shared;
+                    offsetR[i] += gain * ((rightShared * shared) + (rightQuadrature * tables.readQuadrature(id, p)));
+
+                    p += step;
+                    p -= p >= 1.0 ? 1.0 : 0.0;
+                }
+
+                phase[static_cast<size_t>(table)] = p;
+            }
+        }
+
+    private:
+
+        Settings settings;
+        std::array<double, ModulationWavetables::numTables> weights { 0.6, 0.3, 0.1 };
+        double rightShared = 0.5, rightQuadrature = 0.8660254037844386;
+        std::array<double, ModulationWavetables::numTables> increment {};
+        std::array<double, ModulationWavetables::numTables> phase {};
+    };
+}
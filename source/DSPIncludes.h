@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef DSP_INCLUDES_H
+#define DSP_INCLUDES_H
+
+#ifndef DONT_SET_USING_JUCE_NAMESPACE
+#define DONT_SET_USING_JUCE_NAMESPACE 1
+#endif
+
+// Lean include set for the DSP headers. Only juce_core, juce_audio_basics and
+// juce_dsp are pulled in here so the engine can be built without any GUI,
+// plugin-client or web browser modules (see the ToBIAS_DSP target).
+#include <cmath>
+#include <memory>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#endif
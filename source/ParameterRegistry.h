@@ -0,0 +1,231 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include <string_view>
+#include <utility>
+
+namespace MarsDSP
+{
+    // ==============================================================================
+    // PARAMETER REGISTRY
+    // ==============================================================================
+    //
+    // Every parameter is declared once, as a row of parameterTable. The APVTS
+    // layout and pointer binding (Parameters), the headless value store
+    // (ParameterValues), the smoother bank (Smoother) and the typed accessors are
+    // all generated from it at compile time, so adding a parameter is one row
+    // here plus its tag in namespace Param.
+    //
+    // Row order is the host automation order and must not be changed for
+    // released parameters; new parameters are appended with a higher version.
+    //
+    // ==========GAIN============
+    // Input = 0->1 default 0.5
+    // Output = 0->1 default 0.5
+    // ==========TAPE============
+    // Tilt = 0->1 default 0.5
+    // Shape = 0->1 default 0.5
+    // Bias = 0->1 default 0.5
+    // ==========FLUTTER=========
+    // Flutter = 0->1 default 0.5
+    // FSpeed = 0->1 default 0.5
+    // Flutter Mode = Classic / Wavetable default Classic
+    // Wow = 0->1 default 0.6
+    // Capstan = 0->1 default 0.3
+    // Scrape = 0->1 default 0.1
+    // Correlation = 0->1 default 0.5
+    // ==========HEAD============
+    // Bump = 0->1 default 0.5
+    // Freq = 1->150 default 75.0
+    // ==========QUALITY=========
+    // Antialias = Off / ADAA 1st / ADAA 2nd default Off
+    // Hysteresis = Stages / J-A RK2 / J-A RK4 / J-A Newton default Stages
+    // Adaptive Quality = Off / On default Off
+    // Compander = Per Sample / Multi-Rate default Per Sample
+    // ==========BOUNCE==========
+    // Generations = 1->8 default 1
+    // ==========NOISE===========
+    // Hiss = 0->1 default 0
+
+    enum class ParameterKind
+    {
+        continuous,     // juce::AudioParameterFloat, smoothed on the audio thread
+        choice,         // juce::AudioParameterChoice, read as an index
+        integer,        // juce::AudioParameterInt
+        toggle          // juce::AudioParameterBool
+    };
+
+    enum class ParameterUnit
+    {
+        none,
+        percent,
+        hertz
+    };
+
+    // How Smoother ramps a continuous parameter towards a new target
+    enum class SmoothingType
+    {
+        linear,             // constant step
+        multiplicative,     // constant ratio, i.e. linear in dB; for gains
+        exponential         // one-pole approach; for frequencies
+    };
+
+    enum class ChannelLink
+    {
+        linked,             // one smoother shared by every channel
+        perChannel          // independent smoother state per channel
+    };
+
+    struct SmoothingSpec
+    {
+        SmoothingType type = SmoothingType::linear;
+        float rampSeconds = 0.02f;
+        ChannelLink link = ChannelLink::linked;
+    };
+
+    struct ParameterSpec
+    {
+        const char* id;
+        int version;
+        const char* name;
+        ParameterKind kind;
+        float minimum, maximum, defaultValue;
+        ParameterUnit unit = ParameterUnit::none;
+        SmoothingSpec smoothing {};
+        std::array<const char*, 4> choices {};
+    };
+
+    inline constexpr std::array parameterTable
+    {
+        ParameterSpec { "input",      1, "Input",      ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::none,
+                        { SmoothingType::multiplicative, 0.03f } },
+        ParameterSpec { "tilt",       1, "Tilt",       ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "shape",      1, "Shape",      ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "bias",       1, "Bias",       ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "flutter",    1, "Flutter",    ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "speed",      1, "fSpeed",     ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "bump",       1, "BumpHead",   ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::percent },
+        ParameterSpec { "bumpHz",     1, "BumpHz",     ParameterKind::continuous, 1.0f, 150.0f, 75.0f, ParameterUnit::hertz,
+                        { SmoothingType::exponential, 0.08f } },
+        ParameterSpec { "output",     1, "Output",     ParameterKind::continuous, 0.0f, 1.0f,   0.5f,  ParameterUnit::none,
+                        { SmoothingType::multiplicative, 0.03f } },
+        ParameterSpec { "bypass",     1, "Bypass",     ParameterKind::toggle,     0.0f, 1.0f,   0.0f },
+
+        // Off, first or second order ADAA on the saturation and clipper curves
+        ParameterSpec { "antialias",  2, "Antialias",  ParameterKind::choice,     0.0f, 2.0f,   0.0f,  ParameterUnit::none, {},
+                        { "Off", "ADAA 1st", "ADAA 2nd" } },
+
+        // Slew limiter stages, or Jiles-Atherton with the chosen solver
+        ParameterSpec { "hysteresis", 2, "Hysteresis", ParameterKind::choice,     0.0f, 3.0f,   0.0f,  ParameterUnit::none, {},
+                        { "Stages", "J-A RK2", "J-A RK4", "J-A Newton" } },
+
+        // Tape-to-tape bounces, each through its own copy of the tape chain
+        ParameterSpec { "generations", 2, "Generations", ParameterKind::integer,  1.0f, 8.0f,   1.0f },
+
+        // Lets QualityGovernor trade detail for CPU time near the callback deadline
+        ParameterSpec { "adaptiveQuality", 2, "Adaptive Quality", ParameterKind::toggle, 0.0f, 1.0f, 0.0f },
+
+        // Tape hiss and modulation noise; off by default so old sessions are unchanged
+        ParameterSpec { "hiss",       3, "Hiss",       ParameterKind::continuous, 0.0f, 1.0f,   0.0f,  ParameterUnit::percent },
+
+        // Compander detector and gain per sample, or every few samples for less CPU
+        ParameterSpec { "compander",  3, "Compander",  ParameterKind::choice,     0.0f, 1.0f,   0.0f,  ParameterUnit::none, {},
+                        { "Per Sample", "Multi-Rate" } },
+
+        // Classic sine flutter, or the wavetable transport: a wow, capstan
+        // flutter and scrape mix with its own stereo correlation
+        ParameterSpec { "flutterMode", 3, "Flutter Mode", ParameterKind::choice, 0.0f, 1.0f,   0.0f,  ParameterUnit::none, {},
+                        { "Classic", "Wavetable" } },
+        ParameterSpec { "wow",        3, "Wow",        ParameterKind::continuous, 0.0f, 1.0f,   0.6f,  ParameterUnit::percent },
+        ParameterSpec { "capstan",    3, "Capstan",    ParameterKind::continuous, 0.0f, 1.0f,   0.3f,  ParameterUnit::percent },
+        ParameterSpec { "scrape",     3, "Scrape",     ParameterKind::continuous, 0.0f, 1.0f,   0.1f,  ParameterUnit::percent },
+        ParameterSpec { "correlation", 3, "Correlation", ParameterKind::continuous, 0.0f, 1.0f, 0.5f,  ParameterUnit::percent }
+    };
+
+    inline constexpr size_t numParameters = parameterTable.size();
+
+    // Row of a parameter ID, or numParameters if there is none
+    constexpr size_t indexOfParameter(std::string_view id) noexcept
+    {
+        for (size_t i = 0; i < numParameters; ++i)
+            if (std::string_view(parameterTable[i].id) == id)
+                return i;
+
+        return numParameters;
+    }
+
+    inline constexpr size_t numContinuousParameters = []
+    {
+        size_t count = 0;
+        for (const auto& spec : parameterTable)
+            count += spec.kind == ParameterKind::continuous ? 1 : 0;
+        return count;
+    }();
+
+    // Rank of each row among the continuous parameters, numContinuousParameters
+    // for the others
+    inline constexpr std::array<size_t, numParameters> continuousIndex = []
+    {
+        std::array<size_t, numParameters> ranks {};
+        size_t next = 0;
+
+        for (size_t i = 0; i < numParameters; ++i)
+            ranks[i] = parameterTable[i].kind == ParameterKind::continuous ? next++ : numContinuousParameters;
+
+        return ranks;
+    }();
+
+    // Value type a parameter is read as: float, int (choice index or integer) or bool
+    template <ParameterKind Kind>
+    using ParameterValueType = std::conditional_t<Kind == ParameterKind::continuous, float,
+                               std::conditional_t<Kind == ParameterKind::toggle, bool, int>>;
+
+    // Compile-time handle on one row; accessors taking a tag resolve the row
+    // and the value type without any runtime lookup
+    template <size_t Index>
+    struct ParameterTag
+    {
+        static_assert(Index < numParameters, "no such parameter in parameterTable");
+
+        static constexpr size_t index = Index;
+        static constexpr const ParameterSpec& spec = parameterTable[Index];
+        static constexpr ParameterKind kind = spec.kind;
+
+        using ValueType = ParameterValueType<kind>;
+    };
+
+    namespace Param
+    {
+        inline constexpr ParameterTag<indexOfParameter("input")>      input {};
+        inline constexpr ParameterTag<indexOfParameter("tilt")>       tilt {};
+        inline constexpr ParameterTag<indexOfParameter("shape")>      shape {};
+        inline constexpr ParameterTag<indexOfParameter("bias")>       bias {};
+        inline constexpr ParameterTag<indexOfParameter("flutter")>    flutter {};
+        inline constexpr ParameterTag<indexOfParameter("speed")>      speed {};
+        inline constexpr ParameterTag<indexOfParameter("bump")>       bumpHead {};
+        inline constexpr ParameterTag<indexOfParameter("bumpHz")>     bumpHz {};
+        inline constexpr ParameterTag<indexOfParameter("output")>     output {};
+        inline constexpr ParameterTag<indexOfParameter("bypass")>     bypass {};
+        inline constexpr ParameterTag<indexOfParameter("antialias")>  antialias {};
+        inline constexpr ParameterTag<indexOfParameter("hysteresis")> hysteresis {};
+        inline constexpr ParameterTag<indexOfParameter("generations")> generations {};
+        inline constexpr ParameterTag<indexOfParameter("adaptiveQuality")> adaptiveQuality {};
+        inline constexpr ParameterTag<indexOfParameter("hiss")>       hiss {};
+        inline constexpr ParameterTag<indexOfParameter("compander")>  compander {};
+        inline constexpr ParameterTag<indexOfParameter("flutterMode")> flutterMode {};
+        inline constexpr ParameterTag<indexOfParameter("wow")>        wow {};
+        inline constexpr ParameterTag<indexOfParameter("capstan")>    capstan {};
+        inline constexpr ParameterTag<indexOfParameter("scrape")>     scrape {};
+        inline constexpr ParameterTag<indexOfParameter("correlation")> correlation {};
+    }
+
+    // Calls function(ParameterTag<i>{}) for every row, unrolled at compile time
+    template <typename Function>
+    constexpr void forEachParameter(Function&& function)
+    {
+        [&]<size_t... Index>(std::index_sequence<Index...>)
+        {
+            (function(ParameterTag<Index> {}), ...);
+        }(std::make_index_sequence<numParameters> {});
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "ParameterRegistry.h"
+
+namespace MarsDSP
+{
+    // GUI-free parameter set for the headless ToBIAS_DSP library (offline tools,
+    // benchmarks, bindings). One plain value per parameterTable row, stored as a
+    // float like the APVTS does, and read through the same tag accessors as
+    // Parameters so Smoother is written once for both.
+    class ParameterValues
+    {
+    public:
+        ParameterValues() noexcept
+        {
+            for (size_t i = 0; i < numParameters; ++i)
+                values[i].store(parameterTable[i].defaultValue, std::memory_order_relaxed);
+        }
+
+        ~ParameterValues() = default;
+
+        template <size_t Index>
+        typename ParameterTag<Index>::ValueType get(ParameterTag<Index>) const noexcept
+        {
+            const float value = getValue(Index);
+
+            if constexpr (ParameterTag<Index>::kind == ParameterKind::continuous)
+                return value;
+            else if constexpr (ParameterTag<Index>::kind == ParameterKind::toggle)
+                return value >= 0.5f;
+            else
+                return juce::roundToInt(value);
+        }
+
+        template <size_t Index>
+        void set(ParameterTag<Index>, typename ParameterTag<Index>::ValueType newValue) noexcept
+        {
+            setValue(Index, static_cast<float>(newValue));
+        }
+
+        // Runtime-indexed access for bindings and state code; values are plain
+        // (choice index, integer, 0/1 for toggles) and are not range checked
+        float getValue(size_t index) const noexcept { return values[index].load(std::memory_order_relaxed); }
+        void setValue(size_t index, float newValue) noexcept { values[index].store(newValue, std::memory_order_relaxed); }
+
+    private:
+
+        std::array<std::atomic<float>, numParameters> values;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterValues)
+    };
+}
@@ -1,139 +1,130 @@
 #pragma once
 
-#include "Globals.h"
+#include <Includes.h>
 #include "Converters.h"
+#include "ParameterRegistry.h"
 
 namespace MarsDSP {
 
+    // APVTS side of the parameter registry: builds the layout from
+    // parameterTable and binds one pointer per row.
     class Parameters {
 
     public:
 
         explicit Parameters(juce::AudioProcessorValueTreeState& vts)
         {
-            castParameter(vts,  inputParamID,   input);
-            castParameter(vts,  tiltParamID,    tilt);
-            castParameter(vts,  shapeParamID,   shape);
-            castParameter(vts,  biasParamID,    bias);
-            castParameter(vts,  flutterParamID, flutter);
-            castParameter(vts,  fSpeedParamID,  speed);
-            castParameter(vts,  bumpParamID,    bumpHead);
-            castParameter(vts,  bumpHzParamID,  bumpHz);
-            castParameter(vts,  outputParamID,  output);
-            castParameter(vts,  bypassParamID,  bypass);
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                parameters[i] = vts.getParameter(parameterTable[i].id);
+                jassert(parameters[i]);
+            }
         }
 
         static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
         {
             juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-            // Input
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (inputParamID, inputParamIDName, juce::NormalisableRange<float>
-                    { 0.0f, 1.0f }, 0.5f));
-
-            // Tilt
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (tiltParamID, tiltParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // Shape
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (shapeParamID, shapeParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // Bias
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (biasParamID, biasParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // Flutter
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (flutterParamID, flutterParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // Flutter Speed
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (fSpeedParamID, fSpeedParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // Bump Head
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (bumpParamID, bumpParamIDName, juce::NormalisableRange<float>
-                    {0.0f, 1.0f}, 0.5f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromPercent)));
-
-            // BumpHz
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (bumpHzParamID, bumpHzParamIDName, juce::NormalisableRange<float>
-                    {1.0f, 150.0f}, 75.0f,
-                juce::AudioParameterFloatAttributes()
-                .withStringFromValueFunction(Converter::stringFromHz)));
-
-            // Output
-            layout.add(std::make_unique<juce::AudioParameterFloat>
-                (outputParamID, outputParamIDName, juce::NormalisableRange<float>
-                    { 0.0f, 1.0f }, 0.5f));
-
-            // Bypass
-            layout.add(std::make_unique<juce::AudioParameterBool>
-                (bypassParamID, bypassParamIDName, false));
+            for (const auto& spec : parameterTable)
+            {
+                const juce::ParameterID id { spec.id, spec.version };
+
+                switch (spec.kind)
+                {
+                    case ParameterKind::continuous:
+                        layout.add(std::make_unique<juce::AudioParameterFloat>
+                            (id, spec.name, juce::NormalisableRange<float> { spec.minimum, spec.maximum },
+                             spec.defaultValue, attributesFor(spec.unit)));
+                        break;
+
+                    case ParameterKind::choice:
+                    {
+                        juce::StringArray choices;
+                        for (const auto* choice : spec.choices)
+                            if (choice != nullptr)
+                                choices.add(choice);
+
+                        layout.add(std::make_unique<juce::AudioParameterChoice>
+                            (id, spec.name, choices, static_cast<int>(spec.defaultValue)));
+                        break;
+                    }
+
+                    case ParameterKind::integer:
+                        layout.add(std::make_unique<juce::AudioParameterInt>
+                            (id, spec.name, static_cast<int>(spec.minimum), static_cast<int>(spec.maximum),
+                             static_cast<int>(spec.defaultValue)));
+                        break;
+
+                    case ParameterKind::toggle:
+                        layout.add(std::make_unique<juce::AudioParameterBool>
+                            (id, spec.name, spec.defaultValue >= 0.5f));
+                        break;
+
+                    default: break;
+                }
+            }
 
             return layout;
         }
 
         ~Parameters() = default;
 
-        /*
-         * 9
-         * ==========GAIN============
-         * Input = 0->1 default 0.5
-         * Output = 0->1 default 0.5
-         * ==========TAPE============
-         * Tilt = 0->1 default 0.5
-         * Shape = 0->1 default 0.5
-         * Bias = 0->1 default 0.5
-         * ==========FLUTTER=========
-         * Flutter = 0->1 default 0.5
-         * FSpeed = 0->1 default 0.5
-         * ==========HEAD============
-         * Bump = 0->1 default 0.5
-         * Freq = 0->150 default 75.0
-         */
-
-        juce::AudioParameterFloat* input    { nullptr };
-        juce::AudioParameterFloat* tilt     { nullptr };
-        juce::AudioParameterFloat* shape    { nullptr };
-        juce::AudioParameterFloat* bias     { nullptr };
-        juce::AudioParameterFloat* flutter  { nullptr };
-        juce::AudioParameterFloat* speed    { nullptr };
-        juce::AudioParameterFloat* bumpHead { nullptr };
-        juce::AudioParameterFloat* bumpHz   { nullptr };
-        juce::AudioParameterFloat* output   { nullptr };
-
-        juce::AudioParameterBool* bypass {nullptr};
+        // Typed pointer for a row, e.g. parameter(Param::bumpHz)->range
+        template <size_t Index>
+        auto* parameter(ParameterTag<Index>) const noexcept
+        {
+            if constexpr (ParameterTag<Index>::kind == ParameterKind::continuous)
+                return static_cast<juce::AudioParameterFloat*>(parameters[Index]);
+            else if constexpr (ParameterTag<Index>::kind == ParameterKind::choice)
+                return static_cast<juce::AudioParameterChoice*>(parameters[Index]);
+            else if constexpr (ParameterTag<Index>::kind == ParameterKind::integer)
+                return static_cast<juce::AudioParameterInt*>(parameters[Index]);
+            else
+                return static_cast<juce::AudioParameterBool*>(parameters[Index]);
+        }
+
+        // Plain value, as ParameterValues::get
+        template <size_t Index>
+        typename ParameterTag<Index>::ValueType get(ParameterTag<Index> tag) const noexcept
+        {
+            if constexpr (ParameterTag<Index>::kind == ParameterKind::choice)
+                return parameter(tag)->getIndex();
+            else
+                return parameter(tag)->get();
+        }
+
+        // Runtime-indexed plain values (choice index, integer, 0/1 for
+        // toggles), as ParameterValues; for state code. Setting notifies the host.
+        float getValue(size_t index) const noexcept
+        {
+            const auto* p = parameters[index];
+            return p->convertFrom0to1(p->getValue());
+        }
+
+        void setValue(size_t index, float newValue)
+        {
+            auto* p = parameters[index];
+            p->setValueNotifyingHost(p->convertTo0to1(newValue));
+        }
 
     private:
 
-        template<typename T>
-        static void castParameter(juce::AudioProcessorValueTreeState& vts,
-                        const juce::ParameterID& id, T& destination)
+        static juce::AudioParameterFloatAttributes attributesFor(ParameterUnit unit)
         {
-            destination = dynamic_cast<T>(vts.getParameter(id.getParamID()));
-            jassert(destination);
+            switch (unit)
+            {
+                case ParameterUnit::percent:
+                    return juce::AudioParameterFloatAttributes().withStringFromValueFunction(Converter::stringFromPercent);
+                case ParameterUnit::hertz:
+                    return juce::AudioParameterFloatAttributes().withStringFromValueFunction(Converter::stringFromHz);
+                case ParameterUnit::none:
+                default:
+                    return {};
+            }
         }
 
+        std::array<juce::RangedAudioParameter*, numParameters> parameters {};
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Parameters)
     };
-}
\ No newline at end of file
+}
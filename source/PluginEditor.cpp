@@ -1,21 +1,490 @@
 #include "PluginEditor.h"
 
-PluginEditor::PluginEditor(PluginProcessor &p) : AudioProcessorEditor(&p), pref(p)
+//==============================================================================
+NativeParameterView::NativeParameterView(juce::AudioProcessor &processor)
 {
-    juce::ignoreUnused(pref);
-    setSize (900, 450);
+    for (auto* parameter : processor.getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        if (ranged == nullptr)
+            continue;
+
+        Control control;
+
+        if (auto* boolParam = dynamic_cast<juce::AudioParameterBool*>(ranged))
+        {
+            control.toggle = std::make_unique<juce::ToggleButton>(boolParam->getName(32));
+            control.toggleAttachment = std::make_unique<juce::ButtonParameterAttachment>(*boolParam, *control.toggle);
+            addAndMakeVisible(*control.toggle);
+        }
+
+        else
+        {
+            control.label = std::make_unique<juce::Label>(juce::String(), ranged->getName(32));
+            control.label->setJustificationType(juce::Justification::centred);
+            addAndMakeVisible(*control.label);
+
+            control.slider = std::make_unique<juce::Slider>(juce::Slider::RotaryHorizontalVerticalDrag,
+                                                            juce::Slider::TextBoxBelow);
+            control.sliderAttachment = std::make_unique<juce::SliderParameterAttachment>(*ranged, *control.slider);
+            addAndMakeVisible(*control.slider);
+        }
+
+        controls.push_back(std::move(control));
+    }
+}
+
+void NativeParameterView::resized()
+{
+    constexpr int columns = 5;
+    const int rows = juce::jmax(1, (static_cast<int>(controls.size()) + columns - 1) / columns);
+
+    auto bounds = getLocalBounds().reduced(10);
+    const int cellWidth = bounds.getWidth() / columns;
+    const int cellHeight = bounds.getHeight() / rows;
+
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        auto& control = controls[i];
+        const int column = static_cast<int>(i) % columns;
+        const int row = static_cast<int>(i) / columns;
+
+        auto cell = juce::Rectangle<int>(bounds.getX() + column * cellWidth,
+                                         bounds.getY() + row * cellHeight,
+                                         cellWidth, cellHeight).reduced(6);
+
+        if (control.toggle != nullptr)
+        {
+            control.toggle->setBounds(cell.withSizeKeepingCentre(cell.getWidth(), 24));
+            continue;
+        }
+
+        control.label->setBounds(cell.removeFromTop(20));
+        control.slider->setBounds(cell);
+    }
+}
+
+//==============================================================================
+OutputMeter::OutputMeter(PluginProcessor &p, MarsDSP::UI::FrameClock &c) : processor(p), clock(c)
+{
+    setOpaque(true);
+    clock.addClient(*this);
+}
+
+OutputMeter::~OutputMeter()
+{
+    clock.removeClient(*this);
+}
+
+// -60 dB to +6 dB across the width
+int OutputMeter::levelToX(float gain) const noexcept
+{
+    const auto db = juce::Decibels::gainToDecibels(gain, -60.0f);
+    return juce::roundToInt(juce::jmap(juce::jlimit(-60.0f, 6.0f, db), -60.0f, 6.0f, 0.0f, static_cast<float>(getWidth())));
+}
+
+void OutputMeter::frameTick()
+{
+    // About 20 dB per second of fall at 60 Hz, whatever the frame divider
+    const auto fall = std::pow(0.9623f, static_cast<float>(clock.getFrameDivider()));
+    level = juce::jmax(processor.takeOutputPeak(), level * fall);
+
+    const int x = levelToX(level);
+    if (x == drawnX)
+        return;
+
+    repaint(juce::jmin(x, drawnX), 0, std::abs(x - drawnX), getHeight());
+    drawnX = x;
+}
+
+void OutputMeter::resized()
+{
+    drawnX = levelToX(level);
+}
+
+void OutputMeter::paint(juce::Graphics &g)
+{
+    const MarsDSP::UI::FrameClock::ScopedPaintTimer timer(clock);
+
+    const auto bounds = getLocalBounds();
+    g.setColour(juce::Colour(0xff15171a));
+    g.fillRect(bounds);
+
+    const int zeroDb = levelToX(1.0f);
+    g.setColour(juce::Colour(0xff8fbf6a));
+    g.fillRect(bounds.withWidth(juce::jmin(drawnX, zeroDb)));
+
+    if (drawnX > zeroDb)
+    {
+        g.setColour(juce::Colour(0xffd9614c));
+        g.fillRect(bounds.withLeft(zeroDb).withWidth(drawnX - zeroDb));
+    }
+}
+
+//==============================================================================
+QualityBadge::QualityBadge(PluginProcessor &p, MarsDSP::UI::FrameClock &c) : processor(p), clock(c)
+{
+    clock.addClient(*this);
+}
+
+QualityBadge::~QualityBadge()
+{
+    clock.removeClient(*this);
+}
+
+void QualityBadge::frameTick()
+{
+    const int level = processor.getQualityLevel();
+    if (level == shownLevel)
+        return;
+
+    shownLevel = level;
+    repaint();
+}
+
+void QualityBadge::paint(juce::Graphics &g)
+{
+    if (shownLevel == 0)
+        return;
+
+    const MarsDSP::UI::FrameClock::ScopedPaintTimer timer(clock);
+
+    g.setColour(juce::Colour(0xffe0a050));
+    g.setFont(juce::Font(12.0f));
+    g.drawText("Quality -" + juce::String(shownLevel), getLocalBounds(), juce::Justification::centredRight);
+}
+
+//==============================================================================
+SnapshotBar::SnapshotBar(PluginProcessor &p) : processor(p)
+{
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        const int slot = static_cast<int>(i);
+        slots[i].setButtonText(processor.getProgramName(slot));
+        slots[i].onClick = [this, slot] { slotClicked(slot); };
+        addAndMakeVisible(slots[i]);
+    }
+
+    store.setClickingTogglesState(true);
+    addAndMakeVisible(store);
+
+    showCurrent();
+}
+
+void SnapshotBar::resized()
+{
+    auto bounds = getLocalBounds();
+
+    for (auto& slot : slots)
+        slot.setBounds(bounds.removeFromLeft(34).withTrimmedRight(4));
+
+    store.setBounds(bounds.withTrimmedRight(8));
+}
+
+void SnapshotBar::slotClicked(int slot)
+{
+    if (store.getToggleState())
+    {
+        processor.storeSnapshot(slot);
+        store.setToggleState(false, juce::dontSendNotification);
+    }
+
+    else
+    {
+        processor.recallSnapshot(slot);
+    }
+
+    showCurrent();
+}
+
+void SnapshotBar::showCurrent()
+{
+    for (size_t i = 0; i < slots.size(); ++i)
+        slots[i].setToggleState(static_cast<int>(i) == processor.getCurrentProgram(), juce::dontSendNotification);
+}
+
+//==============================================================================
+AnalysisView::AnalysisView(PluginProcessor &p, MarsDSP::UI::FrameClock &c) : processor(p), clock(c)
+{
+    setOpaque(true);
+    incoming.resize(MarsDSP::DSP::AnalysisTap::capacity);
+    clock.addClient(*this);
+}
+
+AnalysisView::~AnalysisView()
+{
+    processor.getAnalysisTap().stop();
+    clock.removeClient(*this);
+}
+
+void AnalysisView::resized()
+{
+    auto bounds = getLocalBounds().reduced(10, 8);
+    transferArea = bounds.removeFromRight(bounds.getHeight());
+    bounds.removeFromRight(10);
+    spectrumArea = bounds.removeFromRight(bounds.getHeight());
+    bounds.removeFromRight(10);
+    scopeArea = bounds;
+
+    // One frame per pixel column across the scope
+    const auto columns = static_cast<size_t>(juce::jmax(1, scopeArea.getWidth()));
+    history.assign(columns, MarsDSP::DSP::AnalysisFrame {});
+    newest = 0;
+
+    const auto sampleRate = processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 48000.0;
+    processor.getAnalysisTap().start(juce::roundToInt(sampleRate * scopeSeconds / static_cast<double>(columns)));
+}
+
+void AnalysisView::frameTick()
+{
+    const auto count = processor.getAnalysisTap().pop(incoming.data(), static_cast<int>(incoming.size()));
+    if (count == 0 || history.empty())
+        return;
+
+    for (int i = 0; i < count; ++i)
+    {
+        newest = (newest + 1) % history.size();
+        history[newest] = incoming[static_cast<size_t>(i)];
+    }
+
+    repaint();
+}
+
+const MarsDSP::DSP::AnalysisFrame& AnalysisView::frameAge(size_t age) const noexcept
+{
+    return history[(newest + history.size() - age) % history.size()];
+}
+
+void AnalysisView::paint(juce::Graphics &g)
+{
+    const MarsDSP::UI::FrameClock::ScopedPaintTimer timer(clock);
+
+    g.fillAll(juce::Colour(0xff15171a));
+
+    if (history.empty())
+        return;
+
+    paintScope(g);
+    paintSpectrum(g);
+    paintTransfer(g);
+}
+
+void AnalysisView::paintScope(juce::Graphics &g) const
+{
+    const auto centre = static_cast<float>(scopeArea.getCentreY());
+    const auto halfHeight = static_cast<float>(scopeArea.getHeight()) * 0.5f;
+    const auto toY = [&](float value) { return centre - (juce::jlimit(-1.0f, 1.0f, value) * halfHeight); };
+
+    g.setColour(juce::Colours::white.withAlpha(0.06f));
+    g.drawHorizontalLine(scopeArea.getCentreY(), static_cast<float>(scopeArea.getX()), static_cast<float>(scopeArea.getRight()));
+
+    // Oldest frame on the left edge, newest on the right
+    const auto columns = history.size();
+    const auto columnX = [&](size_t age) { return scopeArea.getRight() - 1 - static_cast<int>(age); };
+
+    g.setColour(juce::Colours::white.withAlpha(0.18f));
+    for (size_t age = 0; age < columns; ++age)
+    {
+        const auto& frame = frameAge(age);
+        g.drawVerticalLine(columnX(age), toY(frame.inMax), toY(frame.inMin) + 1.0f);
+    }
+
+    g.setColour(juce::Colour(0xff8fbf6a));
+    for (size_t age = 0; age < columns; ++age)
+    {
+        const auto& frame = frameAge(age);
+        g.drawVerticalLine(columnX(age), toY(frame.outMax), toY(frame.outMin) + 1.0f);
+    }
+
+    juce::Path pitch;
+    for (size_t age = 0; age < columns; ++age)
+    {
+        const auto x = static_cast<float>(columnX(age));
+        const auto y = toY(frameAge(age).pitchCents / pitchRangeCents);
+
+        if (age == 0)
+            pitch.startNewSubPath(x, y);
+        else
+            pitch.lineTo(x, y);
+    }
+
+    g.setColour(juce::Colour(0xffe0a050));
+    g.strokePath(pitch, juce::PathStrokeType(1.0f));
+
+    g.setColour(juce::Colours::white.withAlpha(0.4f));
+    g.setFont(juce::Font(11.0f));
+    g.drawText(juce::String::formatted("flutter +/-%.0f cents", pitchRangeCents), scopeArea.withHeight(14),
+               juce::Justification::topRight);
+}
+
+void AnalysisView::paintSpectrum(juce::Graphics &g) const
+{
+    const auto area = spectrumArea.toFloat();
+    constexpr auto numBands = MarsDSP::DSP::analysisBandCentres.size();
+
+    g.setColour(juce::Colours::white.withAlpha(0.06f));
+    g.drawRect(area);
+
+    // Columns are a fraction of a low band's period, so the levels are the
+    // mean over the newest spectrumSeconds of frames
+    const auto frames = juce::jlimit<size_t>(1, history.size(),
+                                             static_cast<size_t>(static_cast<double>(history.size()) * spectrumSeconds / scopeSeconds));
+    std::array<float, numBands> power {};
+
+    for (size_t age = 0; age < frames; ++age)
+        for (size_t b = 0; b < numBands; ++b)
+            power[b] += frameAge(age).bandPower[b];
+
+    const auto barWidth = area.getWidth() / static_cast<float>(numBands);
+
+    for (size_t b = 0; b < numBands; ++b)
+    {
+        const auto db = juce::Decibels::gainToDecibels(std::sqrt(power[b] / static_cast<float>(frames)), spectrumFloorDb);
+        const auto height = juce::jmap(juce::jlimit(spectrumFloorDb, 0.0f, db), spectrumFloorDb, 0.0f, 0.0f, area.getHeight());
+        const auto x = area.getX() + (barWidth * static_cast<float>(b));
+
+        g.setColour(juce::Colour(0xff8fbf6a).withAlpha(0.7f));
+        g.fillRect(juce::Rectangle<float>(x + 1.0f, area.getBottom() - height, barWidth - 2.0f, height));
+    }
+
+    g.setColour(juce::Colours::white.withAlpha(0.4f));
+    g.setFont(juce::Font(11.0f));
+    g.drawText("63 Hz - 8 kHz", spectrumArea.withHeight(14), juce::Justification::topRight);
+}
+
+void AnalysisView::paintTransfer(juce::Graphics &g) const
+{
+    const auto area = transferArea.toFloat();
+    const auto toPoint = [&](float in, float out)
+    {
+        return juce::Point<float>(juce::jmap(juce::jlimit(-1.0f, 1.0f, in), -1.0f, 1.0f, area.getX(), area.getRight()),
+                                  juce::jmap(juce::jlimit(-1.0f, 1.0f, out), -1.0f, 1.0f, area.getBottom(), area.getY()));
+    };
+
+    g.setColour(juce::Colours::white.withAlpha(0.06f));
+    g.drawRect(area);
+    g.drawHorizontalLine(transferArea.getCentreY(), area.getX(), area.getRight());
+    g.drawVerticalLine(transferArea.getCentreX(), area.getY(), area.getBottom());
+
+    g.setColour(juce::Colour(0xff8fbf6a).withAlpha(0.7f));
+    for (size_t age = 0; age < juce::jmin(transferPoints, history.size()); ++age)
+    {
+        const auto& frame = frameAge(age);
+        g.fillRect(juce::Rectangle<float>(2.0f, 2.0f).withCentre(toPoint(frame.inMin, frame.outAtInMin)));
+        g.fillRect(juce::Rectangle<float>(2.0f, 2.0f).withCentre(toPoint(frame.inMax, frame.outAtInMax)));
+    }
+}
+
+//==============================================================================
+PluginEditor::PluginEditor(PluginProcessor &p) : AudioProcessorEditor(&p), pref(p), meter(p, *frameClock),
+                                                  qualityBadge(p, *frameClock), snapshotBar(p), analysis(p, *frameClock)
+{
+    setOpaque(true);
+
+    addAndMakeVisible(meter);
+    addAndMakeVisible(qualityBadge);
+    addAndMakeVisible(snapshotBar);
+    addAndMakeVisible(analysis);
+
+    content = createContent();
+    addAndMakeVisible(*content);
+
+    pref.setEditorOpen(true);
+
+    setSize (900, 600);
 }
 
 PluginEditor::~PluginEditor()
 {
+    pref.setEditorOpen(false);
+}
+juce::File PluginEditor::getWebUIIndexFile()
+{
+    return juce::File::getSpecialLocation(juce::File::currentExecutableFile)
+        .getSiblingFile("ui")
+        .getChildFile("index.html");
+}
+
+std::unique_ptr<juce::Component> PluginEditor::createContent()
+{
+#if JUCE_WEB_BROWSER
+    const auto index = getWebUIIndexFile();
+
+    if (index.existsAsFile())
+    {
+        auto browser = std::make_unique<juce::WebBrowserComponent>();
+        browser->goToURL(juce::URL(index).toString(false));
+        return browser;
+    }
+#endif
+
+    return std::make_unique<NativeParameterView>(pref);
 }
 
 void PluginEditor::paint(juce::Graphics &g)
 {
-    g.setColour(juce::Colours::black.withAlpha(0.3f));
-    g.fillRect(getLocalBounds());
+    const MarsDSP::UI::FrameClock::ScopedPaintTimer timer(*frameClock);
+
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (background.isNull() || scale != backgroundScale)
+        renderBackground(scale);
+
+    g.drawImage(background, getLocalBounds().toFloat());
+}
+
+void PluginEditor::renderBackground(float scale)
+{
+    backgroundScale = scale;
+
+    const auto width = juce::jmax(1, juce::roundToInt(static_cast<float>(getWidth()) * scale));
+    const auto height = juce::jmax(1, juce::roundToInt(static_cast<float>(getHeight()) * scale));
+    background = juce::Image(juce::Image::RGB, width, height, false);
+
+    juce::Graphics g(background);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    const auto bounds = getLocalBounds().toFloat();
+    g.setGradientFill(juce::ColourGradient(juce::Colour(0xff2b2e33), bounds.getTopLeft(),
+                                           juce::Colour(0xff1b1d20), bounds.getBottomLeft(), false));
+    g.fillAll();
+
+#if JUCE_TARGET_HAS_BINARY_DATA
+    // Decoded once per process; ImageCache hands every editor the same image
+    const auto noise = juce::ImageCache::getFromMemory(BinaryData::Noise_png, BinaryData::Noise_pngSize);
+    if (noise.isValid())
+    {
+        g.setTiledImageFill(noise, 0, 0, 0.06f);
+        g.fillAll();
+    }
+#endif
+
+    const auto header = bounds.withHeight(static_cast<float>(headerHeight));
+    g.setColour(juce::Colours::black.withAlpha(0.35f));
+    g.fillRect(header);
+    g.setColour(juce::Colours::white.withAlpha(0.08f));
+    g.drawHorizontalLine(headerHeight - 1, 0.0f, bounds.getWidth());
+
+    g.setColour(juce::Colour(0xffe6e1d6));
+    g.setFont(juce::Font(18.0f, juce::Font::bold));
+    g.drawText("ToBIAS", header.reduced(14.0f, 0.0f), juce::Justification::centredLeft);
+
+    g.setColour(juce::Colours::white.withAlpha(0.4f));
+    g.setFont(juce::Font(12.0f));
+    g.drawText("MarsDSP", header.reduced(14.0f, 0.0f).withTrimmedLeft(80.0f), juce::Justification::centredLeft);
 }
 
 void PluginEditor::resized()
 {
-}
\ No newline at end of file
+    background = {};
+
+    auto bounds = getLocalBounds();
+    auto header = bounds.removeFromTop(headerHeight);
+
+    meter.setBounds(header.removeFromRight(180).reduced(14, 13));
+    qualityBadge.setBounds(header.removeFromRight(100));
+    snapshotBar.setBounds(header.removeFromRight(150).reduced(0, 7));
+    analysis.setBounds(bounds.removeFromBottom(analysisHeight));
+
+    if (content != nullptr)
+        content->setBounds(bounds);
+}
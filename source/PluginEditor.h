@@ -1,8 +1,163 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "UI/FrameClock.h"
 
 //==============================================================================
+// Native fallback UI: one control per processor parameter, bound through
+// parameter attachments. Used whenever the web UI is disabled or not installed.
+class NativeParameterView : public juce::Component
+{
+public:
+    explicit NativeParameterView (juce::AudioProcessor&);
+    ~NativeParameterView() override = default;
+
+    void resized() override;
+
+private:
+
+    struct Control
+    {
+        std::unique_ptr<juce::Label> label;
+        std::unique_ptr<juce::Slider> slider;
+        std::unique_ptr<juce::ToggleButton> toggle;
+        std::unique_ptr<juce::SliderParameterAttachment> sliderAttachment;
+        std::unique_ptr<juce::ButtonParameterAttachment> toggleAttachment;
+    };
+
+    std::vector<Control> controls;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NativeParameterView)
+};
+
+//==============================================================================
+// Output level bar in the header. Opaque, and animated from the shared
+// FrameClock: each tick repaints only the columns between the old and new
+// bar ends, and nothing at all while the level holds still.
+class OutputMeter : public juce::Component, private MarsDSP::UI::FrameClock::Client
+{
+public:
+    OutputMeter (PluginProcessor&, MarsDSP::UI::FrameClock&);
+    ~OutputMeter() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+
+    void frameTick() override;
+    juce::Component& getFrameComponent() override { return *this; }
+
+    int levelToX (float gain) const noexcept;
+
+    PluginProcessor& processor;
+    MarsDSP::UI::FrameClock& clock;
+
+    float level = 0.0f;
+    int drawnX = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OutputMeter)
+};
+
+//==============================================================================
+// Shows the adaptive quality level while the governor has stepped down, and
+// repaints only when the level changes.
+class QualityBadge : public juce::Component, private MarsDSP::UI::FrameClock::Client
+{
+public:
+    QualityBadge (PluginProcessor&, MarsDSP::UI::FrameClock&);
+    ~QualityBadge() override;
+
+    void paint (juce::Graphics&) override;
+
+private:
+
+    void frameTick() override;
+    juce::Component& getFrameComponent() override { return *this; }
+
+    PluginProcessor& processor;
+    MarsDSP::UI::FrameClock& clock;
+    int shownLevel = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (QualityBadge)
+};
+
+//==============================================================================
+// A/B snapshot buttons. Clicking A or B morphs to that snapshot; with Store
+// armed, the click saves the current settings into the slot instead.
+class SnapshotBar : public juce::Component
+{
+public:
+    explicit SnapshotBar (PluginProcessor&);
+    ~SnapshotBar() override = default;
+
+    void resized() override;
+
+private:
+
+    void slotClicked (int slot);
+    void showCurrent();
+
+    PluginProcessor& processor;
+
+    std::array<juce::TextButton, PluginProcessor::numSnapshots> slots;
+    juce::TextButton store { "Store" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SnapshotBar)
+};
+
+//==============================================================================
+// Consumer side of the processor's AnalysisTap. The left half scrolls the
+// input (faint) and output envelopes over the last few seconds, one tap frame
+// per pixel column, with the flutter pitch deviation drawn over them. Next to
+// it, the output's octave band levels averaged over the newest frames; on the
+// right, output against input at each column's extremes, which traces the
+// transfer curve and its hysteresis. The tap runs only while this view
+// exists, and a tick with no new frames repaints nothing.
+class AnalysisView : public juce::Component, private MarsDSP::UI::FrameClock::Client
+{
+public:
+    AnalysisView (PluginProcessor&, MarsDSP::UI::FrameClock&);
+    ~AnalysisView() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+
+    void frameTick() override;
+    juce::Component& getFrameComponent() override { return *this; }
+
+    void paintScope (juce::Graphics&) const;
+    void paintSpectrum (juce::Graphics&) const;
+    void paintTransfer (juce::Graphics&) const;
+
+    // Frames back from the newest, 0 being the newest
+    const MarsDSP::DSP::AnalysisFrame& frameAge (size_t age) const noexcept;
+
+    static constexpr double scopeSeconds = 3.0;
+    static constexpr float pitchRangeCents = 10.0f;
+    static constexpr size_t transferPoints = 384;
+    static constexpr double spectrumSeconds = 0.3;
+    static constexpr float spectrumFloorDb = -72.0f;
+
+    PluginProcessor& processor;
+    MarsDSP::UI::FrameClock& clock;
+
+    juce::Rectangle<int> scopeArea, spectrumArea, transferArea;
+
+    std::vector<MarsDSP::DSP::AnalysisFrame> history, incoming;
+    size_t newest = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalysisView)
+};
+
+//==============================================================================
+// Static layers (background gradient, Noise.png texture, header) are rendered
+// once into an image at the display's pixel scale and only blitted in paint();
+// the image is rebuilt on resize or when the window moves to a screen with a
+// different scale. Animation comes from the process-wide FrameClock rather
+// than a timer per instance.
 class PluginEditor : public juce::AudioProcessorEditor
 {
 public:
@@ -13,9 +168,31 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Location of the optional web UI bundle, next to the plugin binary
+    static juce::File getWebUIIndexFile();
+
 private:
 
+    // The browser is only ever created here, when the editor opens, so plugin
+    // instances without an open UI never load WebKit or spawn its helper.
+    std::unique_ptr<juce::Component> createContent();
+
+    void renderBackground (float scale);
+
+    static constexpr int headerHeight = 36;
+    static constexpr int analysisHeight = 150;
+
     PluginProcessor &pref;
+    juce::SharedResourcePointer<MarsDSP::UI::FrameClock> frameClock;
+
+    juce::Image background;
+    float backgroundScale = 0.0f;
+
+    OutputMeter meter;
+    QualityBadge qualityBadge;
+    SnapshotBar snapshotBar;
+    AnalysisView analysis;
+    std::unique_ptr<juce::Component> content;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginEditor)
-};
\ No newline at end of file
+};
@@ -7,9 +7,17 @@ PluginProcessor::PluginProcessor() : AudioProcessor(BusesProperties()
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
                             params(vts)
 {
+    snapshots.fill(MarsDSP::PluginState::defaultValues());
+
+    for (const auto& spec : MarsDSP::parameterTable)
+        vts.addParameterListener(spec.id, this);
 }
 
-PluginProcessor::~PluginProcessor() = default;
+PluginProcessor::~PluginProcessor()
+{
+    for (const auto& spec : MarsDSP::parameterTable)
+        vts.removeParameterListener(spec.id, this);
+}
 //==============================================================================
 const juce::String PluginProcessor::getName() const
 {
@@ -50,24 +58,22 @@ double PluginProcessor::getTailLengthSeconds() const
 
 int PluginProcessor::getNumPrograms()
 {
-    return 1; // NB: some hosts don't cope very well if you tell them there are 0 programs,
-              // so this should be at least 1, even if you're not really implementing programs.
+    return numSnapshots;
 }
 
 int PluginProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentSnapshot;
 }
 
 void PluginProcessor::setCurrentProgram(int index)
 {
-    juce::ignoreUnused(index);
+    recallSnapshot(index);
 }
 
 const juce::String PluginProcessor::getProgramName(int index)
 {
-    juce::ignoreUnused(index);
-    return {};
+    return juce::String::charToString(static_cast<juce::juce_wchar>('A' + index));
 }
 
 void PluginProcessor::changeProgramName(int index, const juce::String &newName)
@@ -75,9 +81,62 @@ void PluginProcessor::changeProgramName(int index, const juce::String &newName)
     juce::ignoreUnused(index, newName);
 }
 
+//==============================================================================
+// Bypass and Adaptive Quality are how the engine is run, not part of the sound
+bool PluginProcessor::isInSnapshots(size_t index) noexcept
+{
+    return index != MarsDSP::Param::bypass.index && index != MarsDSP::Param::adaptiveQuality.index;
+}
+
+MarsDSP::PluginState::ValueSet PluginProcessor::currentValues() const
+{
+    MarsDSP::PluginState::ValueSet values {};
+
+    for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+        values[i] = params.getValue(i);
+
+    return values;
+}
+
+void PluginProcessor::storeSnapshot(int slot)
+{
+    if (! juce::isPositiveAndBelow(slot, numSnapshots))
+        return;
+
+    snapshots[static_cast<size_t>(slot)] = currentValues();
+    currentSnapshot = slot;
+}
+
+// Both ends of the morph are worked out here, off the audio thread. The
+// parameters are set afterwards, so the host sees the snapshot values; the
+// audio thread ignores their smoothing while the morph runs, and holds a
+// change of Generations until it ends.
+void PluginProcessor::recallSnapshot(int slot, double seconds)
+{
+    if (! juce::isPositiveAndBelow(slot, numSnapshots))
+        return;
+
+    const auto current = currentValues();
+    auto target = snapshots[static_cast<size_t>(slot)];
+
+    for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+        if (! isInSnapshots(i))
+            target[i] = current[i];
+
+    processDSP.morphBetween(current, target, seconds);
+
+    for (size_t i = 0; i < MarsDSP::numParameters; ++i)
+        if (isInSnapshots(i))
+            params.setValue(i, target[i]);
+
+    currentSnapshot = slot;
+}
+
+// May arrive on the audio thread; Job::wake is safe there
 void PluginProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
     juce::ignoreUnused(parameterID, newValue);
+    coefficientJob.wake();
 }
 
 void PluginProcessor::updateParameters()
@@ -89,10 +148,13 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     processDSP.prepareDSP(sampleRate, static_cast<juce::uint32>(samplesPerBlock),
                 static_cast<juce::uint32>(getTotalNumOutputChannels()), params);
+
+    worker->add(coefficientJob);
 }
 
 void PluginProcessor::releaseResources()
 {
+    worker->remove(coefficientJob);
 }
 
 bool PluginProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
@@ -117,11 +179,39 @@ bool PluginProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
 #endif
 }
 
+// Single writer; a peak the editor takes between the load and the store is
+// simply shown one frame later
+template <typename SampleType>
+void PluginProcessor::feedEditor(const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if (! editorOpen.load(std::memory_order_relaxed))
+        return;
+
+    const auto peak = static_cast<float>(buffer.getMagnitude(0, buffer.getNumSamples()));
+    outputPeak.store(juce::jmax(peak, outputPeak.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+}
+
 void PluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                    juce::MidiBuffer &midiMessages)
 {
     juce::ignoreUnused(midiMessages);
     processDSP.process(buffer);
+    feedEditor(buffer);
+}
+
+// 64-bit hosts hand their buffers straight to the double instantiation of the
+// tape chain, which computes in double anyway, so no float conversion happens
+void PluginProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                   juce::MidiBuffer &midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    processDSP.process(buffer);
+    feedEditor(buffer);
+}
+
+bool PluginProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
 }
 
 //==============================================================================
@@ -132,17 +222,21 @@ bool PluginProcessor::hasEditor() const
 
 juce::AudioProcessorEditor *PluginProcessor::createEditor()
 {
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new PluginEditor(*this);
 }
 
 //==============================================================================
+// Binary state (see PluginState.h); sessions saved before it existed hold XML
 void PluginProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    copyXmlToBinary(*vts.copyState().createXml(), destData);
+    MarsDSP::PluginState::write(params, destData, snapshots.data(), snapshots.size());
 }
 
 void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    if (MarsDSP::PluginState::read(params, data, sizeInBytes, snapshots.data(), snapshots.size()))
+        return;
+
     // Restore the parameters state from the given data
     const std::unique_ptr xml(getXmlFromBinary(data, sizeInBytes));
     if (xml.get() != nullptr && xml->hasTagName(vts.state.getType()))
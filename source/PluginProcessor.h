@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Parameters.h"
+#include "PluginState.h"
 #include "DSP/ProcessDSP.h"
 
 class PluginProcessor : public juce::AudioProcessor, private juce::AudioProcessorValueTreeState::Listener
@@ -18,6 +19,8 @@ public:
     bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
 
     void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+    void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     juce::AudioProcessorEditor *createEditor() override;
     bool hasEditor() const override;
@@ -38,15 +41,53 @@ public:
     void getStateInformation(juce::MemoryBlock &destData) override;
     void setStateInformation(const void *data, int sizeInBytes) override;
 
+    // Editor feed. The audio thread only measures while an editor is open, so
+    // instances without a window pay one relaxed load per block.
+    void setEditorOpen(bool isOpen) noexcept { editorOpen.store(isOpen, std::memory_order_relaxed); }
+
+    // Highest output magnitude since the last call
+    float takeOutputPeak() noexcept { return outputPeak.exchange(0.0f, std::memory_order_relaxed); }
+
+    // Adaptive quality level in use, 0 being full quality
+    int getQualityLevel() const noexcept { return processDSP.getQualityLevel(); }
+
+    // Scope and transfer-curve frames; the editor starts and stops the feed
+    MarsDSP::DSP::AnalysisTap& getAnalysisTap() noexcept { return processDSP.getAnalysisTap(); }
+
+    // A/B snapshots, also exposed to the host as programs "A" and "B". Recalling
+    // one morphs the sound over morphSeconds and then leaves the parameters at
+    // the snapshot. Bypass and Adaptive Quality are not part of a snapshot.
+    // Message thread.
+    static constexpr int numSnapshots = 2;
+    static constexpr double morphSeconds = 0.2;
+
+    void storeSnapshot(int slot);
+    void recallSnapshot(int slot, double seconds = morphSeconds);
+
 private:
 
     MarsDSP::Parameters params;
-    MarsDSP::DSP::ProcessBlock processDSP;
+    MarsDSP::DSP::ProcessBlock<MarsDSP::Parameters> processDSP;
+
+    // Designs coefficients off the audio thread on the worker every instance
+    // shares; declared after processDSP so the job leaves before that goes
+    juce::SharedResourcePointer<MarsDSP::BackgroundWorker> worker;
+    MarsDSP::BackgroundWorker::Job coefficientJob { [this] { processDSP.rebuildCoefficients(); } };
 
     void updateParameters();
     void parameterChanged(const juce::String& parameterID, float newValue) override;
 
-    
+    template <typename SampleType>
+    void feedEditor(const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    static bool isInSnapshots(size_t index) noexcept;
+    MarsDSP::PluginState::ValueSet currentValues() const;
+
+    std::array<MarsDSP::PluginState::ValueSet, numSnapshots> snapshots;
+    int currentSnapshot = 0;
+
+    std::atomic<bool> editorOpen { false };
+    std::atomic<float> outputPeak { 0.0f };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor)
 };
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <DSPIncludes.h>
+#include "ParameterRegistry.h"
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+namespace MarsDSP
+{
+    // ==============================================================================
+    // PLUGIN STATE
+    // ==============================================================================
+    //
+    // Compact binary session state, written and read straight from the host's
+    // memory without building an XML document or a ValueTree. All fields are
+    // little endian:
+    //
+    //   uint32  magic           "TBst"
+    //   uint16  formatVersion
+    //   uint16  numEntries
+    //   numEntries x { uint32 idHash, float32 plainValue }
+    //
+    // Version 2 appends the stored snapshots (A/B programs):
+    //
+    //   uint16  numSnapshots
+    //   uint16  entriesPerSnapshot
+    //   numSnapshots x entriesPerSnapshot x { uint32 idHash, float32 plainValue }
+    //
+    // Entries are keyed by a hash of the parameter ID rather than by row, so
+    // parameters can be appended, and an older build skips entries it does not
+    // know. Parameters missing from the data fall back to their defaults, as
+    // they would through replaceState. Later format versions may only append
+    // sections after the entries, so every version can read the entries of
+    // every other.
+    //
+    // ParametersType is anything with runtime-indexed plain values,
+    // getValue(index) and setValue(index, value): Parameters in the plugin,
+    // ParameterValues in the headless library.
+    namespace PluginState
+    {
+        inline constexpr juce::uint32 magic = 0x74734254;   // "TBst"
+        inline constexpr juce::uint16 formatVersion = 2;
+        inline constexpr size_t headerSize = 8;
+        inline constexpr size_t entrySize = 8;
+
+        // FNV-1a; stable across builds and platforms
+        constexpr juce::uint32 hashOf(std::string_view id) noexcept
+        {
+            juce::uint32 hash = 2166136261u;
+
+            for (const char c : id)
+                hash = (hash ^ static_cast<juce::uint8>(c)) * 16777619u;
+
+            return hash;
+        }
+
+        inline constexpr std::array<juce::uint32, numParameters> idHashes = []
+        {
+            std::array<juce::uint32, numParameters> hashes {};
+
+            for (size_t i = 0; i < numParameters; ++i)
+                hashes[i] = hashOf(parameterTable[i].id);
+
+            return hashes;
+        }();
+
+        static_assert([]
+        {
+            for (size_t i = 0; i < numParameters; ++i)
+                for (size_t j = i + 1; j < numParameters; ++j)
+                    if (idHashes[i] == idHashes[j])
+                        return false;
+
+            return true;
+        }(), "two parameter IDs share a state hash; rename one");
+
+        // One plain value per parameterTable row
+        using ValueSet = std::array<float, numParameters>;
+
+        inline ValueSet defaultValues() noexcept
+        {
+            ValueSet values {};
+
+            for (size_t i = 0; i < numParameters; ++i)
+                values[i] = parameterTable[i].defaultValue;
+
+            return values;
+        }
+
+        inline constexpr size_t sectionHeaderSize = 4;
+
+        constexpr size_t sizeInBytes(size_t numSnapshots) noexcept
+        {
+            return headerSize + (numParameters * entrySize) + sectionHeaderSize + (numSnapshots * numParameters * entrySize);
+        }
+
+        namespace Detail
+        {
+            inline void write32(char* destination, juce::uint32 value) noexcept
+            {
+                value = juce::ByteOrder::swapIfBigEndian(value);
+                std::memcpy(destination, &value, sizeof(value));
+            }
+
+            inline void write16(char* destination, juce::uint16 value) noexcept
+            {
+                value = juce::ByteOrder::swapIfBigEndian(value);
+                std::memcpy(destination, &value, sizeof(value));
+            }
+
+            inline juce::uint32 read32(const char* source) noexcept { return juce::ByteOrder::littleEndianInt(source); }
+            inline juce::uint16 read16(const char* source) noexcept { return juce::ByteOrder::littleEndianShort(source); }
+
+            template <typename ValueAt>
+            char* writeEntries(char* out, ValueAt&& valueAt) noexcept
+            {
+                for (size_t i = 0; i < numParameters; ++i, out += entrySize)
+                {
+                    write32(out, idHashes[i]);
+                    write32(out + 4, std::bit_cast<juce::uint32>(static_cast<float>(valueAt(i))));
+                }
+
+                return out;
+            }
+
+            // Entries are matched by ID; rows without one keep their default
+            inline ValueSet readEntries(const char* in, size_t numEntries) noexcept
+            {
+                auto values = defaultValues();
+
+                for (size_t e = 0; e < numEntries; ++e, in += entrySize)
+                {
+                    const auto hash = read32(in);
+                    const auto value = std::bit_cast<float>(read32(in + 4));
+
+                    // Rows are usually in table order, so try the entry's own row first
+                    size_t row = e < numParameters && idHashes[e] == hash ? e : numParameters;
+
+                    for (size_t i = 0; row == numParameters && i < numParameters; ++i)
+                        if (idHashes[i] == hash)
+                            row = i;
+
+                    if (row < numParameters && std::isfinite(value))
+                        values[row] = juce::jlimit(parameterTable[row].minimum, parameterTable[row].maximum, value);
+                }
+
+                return values;
+            }
+        }
+
+        // True if data starts like binary state; anything else is left to the
+        // XML fallback
+        inline bool isBinaryState(const void* data, int size) noexcept
+        {
+            return data != nullptr && size >= static_cast<int>(headerSize)
+                && Detail::read32(static_cast<const char*>(data)) == magic;
+        }
+
+        // Replaces destination's contents with the current values and the
+        // given snapshots
+        template <typename ParametersType>
+        void write(const ParametersType& params, juce::MemoryBlock& destination, const ValueSet* snapshots = nullptr, size_t numSnapshots = 0)
+        {
+            destination.setSize(sizeInBytes(numSnapshots), false);
+            auto* out = static_cast<char*>(destination.getData());
+
+            Detail::write32(out, magic);
+            Detail::write16(out + 4, formatVersion);
+            Detail::write16(out + 6, static_cast<juce::uint16>(numParameters));
+            out = Detail::writeEntries(out + headerSize, [&params](size_t i) { return params.getValue(i); });
+
+            Detail::write16(out, static_cast<juce::uint16>(numSnapshots));
+            Detail::write16(out + 2, static_cast<juce::uint16>(numParameters));
+            out += sectionHeaderSize;
+
+            for (size_t s = 0; s < numSnapshots; ++s)
+                out = Detail::writeEntries(out, [&snapshot = snapshots[s]](size_t i) { return snapshot[i]; });
+        }
+
+        // Applies binary state to params and returns true, or returns false
+        // and leaves params alone if data is not binary state or is truncated.
+        // Snapshots found in the data replace the first numSnapshots of
+        // snapshots; the others, and all of them for version 1 data, are left
+        // as they were.
+        template <typename ParametersType>
+        bool read(ParametersType& params, const void* data, int size, ValueSet* snapshots = nullptr, size_t numSnapshots = 0)
+        {
+            if (! isBinaryState(data, size))
+                return false;
+
+            const auto* in = static_cast<const char*>(data);
+            const auto* end = in + size;
+            const auto version = Detail::read16(in + 4);
+            const size_t numEntries = Detail::read16(in + 6);
+
+            if (static_cast<size_t>(size) < headerSize + (numEntries * entrySize))
+                return false;
+
+            const auto values = Detail::readEntries(in + headerSize, numEntries);
+            in += headerSize + (numEntries * entrySize);
+
+            for (size_t i = 0; i < numParameters; ++i)
+                params.setValue(i, values[i]);
+
+            if (version < 2 || end - in < static_cast<std::ptrdiff_t>(sectionHeaderSize))
+                return true;
+
+            const size_t storedSnapshots = Detail::read16(in);
+            const size_t entriesPerSnapshot = Detail::read16(in + 2);
+            in += sectionHeaderSize;
+
+            for (size_t s = 0; s < storedSnapshots && s < numSnapshots; ++s, in += entriesPerSnapshot * entrySize)
+            {
+                if (end - in < static_cast<std::ptrdiff_t>(entriesPerSnapshot * entrySize))
+                    break;
+
+                snapshots[s] = Detail::readEntries(in, entriesPerSnapshot);
+            }
+
+            return true;
+        }
+    }
+}
@@ -1,137 +1,163 @@
 #pragma once
 
-#include <Includes.h>
+#include <DSPIncludes.h>
+#include "ParameterRegistry.h"
 
 namespace MarsDSP
 {
-    template <typename ParametersType>
-    class Smoother
+    // Slot layout of the smoother bank, fixed at compile time by parameterTable
+    namespace SmootherLayout
     {
-    public:
-        explicit Smoother(const ParametersType& p) : params(p) {}
+        inline constexpr size_t numChannels = 2;
 
-        void prepare(const juce::dsp::ProcessSpec& spec) noexcept
+        constexpr size_t widthOf(const ParameterSpec& spec) noexcept
         {
-            constexpr double duration = 0.02;
-            const int steps = static_cast<int>(spec.sampleRate * duration);
-            auto resetAll = [steps](auto& smootherArray)
-            {
-                for (auto& smoother : smootherArray)
-                    smoother.reset(steps);
-            };
-
-            resetAll(inputSmoother);
-            resetAll(tiltSmoother);
-            resetAll(shapeSmoother);
-            resetAll(biasSmoother);
-            resetAll(flutterSmoother);
-            resetAll(speedSmoother);
-            resetAll(bumpHeadSmoother);
-            resetAll(bumpHzSmoother);
-            resetAll(outputSmoother);
+            if (spec.kind != ParameterKind::continuous)
+                return 0;
+
+            return spec.smoothing.link == ChannelLink::linked ? 1 : numChannels;
         }
 
-        void reset() noexcept
+        // First slot of each row
+        inline constexpr std::array<size_t, numParameters> firstSlot = []
         {
-            input = 0.0f;
-            for (auto& smoother : inputSmoother)
-                smoother.setCurrentAndTargetValue(params.input->get());
-
-            tilt = 0.0f;
-            for (auto& smoother : tiltSmoother)
-                smoother.setCurrentAndTargetValue(params.tilt->get());
+            std::array<size_t, numParameters> slots {};
+            size_t next = 0;
 
-            shape = 0.0f;
-            for (auto& smoother : shapeSmoother)
-                smoother.setCurrentAndTargetValue(params.shape->get());
-
-            bias = 1.0f;
-            for (auto& smoother : biasSmoother)
-                smoother.setCurrentAndTargetValue(params.bias->get());
-
-            flutter = 0.0f;
-            for (auto& smoother : flutterSmoother)
-                smoother.setCurrentAndTargetValue(params.flutter->get());
+            for (size_t i = 0; i < numParameters; ++i)
+            {
+                slots[i] = next;
+                next += widthOf(parameterTable[i]);
+            }
 
-            speed = 0.0f;
-            for (auto& smoother : speedSmoother)
-                smoother.setCurrentAndTargetValue(params.speed->get());
+            return slots;
+        }();
 
-            bumpHead = 0.0f;
-            for (auto& smoother : bumpHeadSmoother)
-                smoother.setCurrentAndTargetValue(params.bumpHead->get());
+        inline constexpr size_t numSlots = firstSlot[numParameters - 1] + widthOf(parameterTable[numParameters - 1]);
 
-            bumpHz = 0.0f;
-            for (auto& smoother : bumpHzSmoother)
-                smoother.setCurrentAndTargetValue(params.bumpHz->get());
+        // Parameter row of each slot
+        inline constexpr std::array<size_t, numSlots> slotParameter = []
+        {
+            std::array<size_t, numSlots> rows {};
+
+            for (size_t i = 0; i < numParameters; ++i)
+                for (size_t channel = 0; channel < widthOf(parameterTable[i]); ++channel)
+                    rows[firstSlot[i] + channel] = i;
+
+            return rows;
+        }();
+    }
+
+    // Smoother bank generated from parameterTable. Each continuous parameter
+    // owns one slot in a set of contiguous arrays (structure of arrays), or one
+    // slot per channel when its SmoothingSpec is ChannelLink::perChannel, and is
+    // ramped with its own SmoothingType and ramp time. Update and skip are single
+    // passes over dense memory; fillRamp() hands out whole blocks of a ramp at
+    // once. Choice and toggle parameters are latched once per update().
+    template <typename ParametersType>
+    class Smoother
+    {
+    public:
+        static constexpr size_t numChannels = SmootherLayout::numChannels;
 
-            output = 0.0f;
-            for (auto& smoother : outputSmoother)
-                smoother.setCurrentAndTargetValue(params.output->get());
+        explicit Smoother(const ParametersType& p) : params(p) {}
 
+        void prepare(const juce::dsp::ProcessSpec& spec) noexcept
+        {
+            for (size_t i = 0; i < numSlots; ++i)
+            {
+                stepsToTarget[i] = static_cast<int>(spec.sampleRate * slotSpec(i).rampSeconds);
+                jump(i, target[i]);
+            }
         }
 
-        void update() noexcept
+        // Keeps every running ramp on course across a sample rate change: the
+        // samples left are rescaled and the steps recomputed to cover them, so
+        // each ramp still ends when it would have in time. Allocates nothing.
+        void changeSampleRate(double previousSampleRate, double newSampleRate) noexcept
         {
-            const float inGain = params.input->get();
-            for (auto& smoother : inputSmoother)
-                smoother.setTargetValue(inGain);
+            const double ratio = newSampleRate / previousSampleRate;
 
-            const float newTilt = params.tilt->get();
-            for (auto& smoother : tiltSmoother)
-                smoother.setTargetValue(newTilt);
-
-            const float newShape = params.shape->get();
-            for (auto& smoother : shapeSmoother)
-                smoother.setTargetValue(newShape);
-
-            const float newBias = params.bias->get();
-            for (auto& smoother : biasSmoother)
-                smoother.setTargetValue(newBias);
-
-            const float newFlutter = params.flutter->get();
-            for (auto& smoother : flutterSmoother)
-                smoother.setTargetValue(newFlutter);
+            for (size_t i = 0; i < numSlots; ++i)
+            {
+                stepsToTarget[i] = static_cast<int>(newSampleRate * slotSpec(i).rampSeconds);
+
+                if (countdown[i] <= 0)
+                    continue;
+
+                countdown[i] = std::max(1, static_cast<int>(std::lround(countdown[i] * ratio)));
+                const auto steps = static_cast<float>(countdown[i]);
+
+                switch (slotSpec(i).type)
+                {
+                    case SmoothingType::linear:         step[i] = (target[i] - current[i]) / steps; break;
+                    case SmoothingType::multiplicative: step[i] = std::exp((std::log(juce::jmax(target[i], multiplicativeFloor)) - std::log(current[i])) / steps); break;
+                    case SmoothingType::exponential:    step[i] = std::pow(step[i], static_cast<float>(1.0 / ratio)); break;
+                    default: break;
+                }
+            }
+        }
 
-            const float newFlutterSpeed = params.speed->get();
-            for (auto& smoother : speedSmoother)
-                smoother.setTargetValue(newFlutterSpeed);
+        // True if this bank reads p, i.e. can be kept over a re-prepare
+        bool isReading(const ParametersType& p) const noexcept { return &p == &params; }
 
-            const float newBumpHead = params.bumpHead->get();
-            for (auto& smoother : bumpHeadSmoother)
-                smoother.setTargetValue(newBumpHead);
+        void reset() noexcept
+        {
+            readTargets();
 
-            const float newBumpHz = params.bumpHz->get();
-            for (auto& smoother : bumpHzSmoother)
-                smoother.setTargetValue(newBumpHz);
+            for (size_t i = 0; i < numSlots; ++i)
+                jump(i, incoming[i]);
+        }
 
-            const float outGain = params.output->get();
-            for (auto& smoother : outputSmoother)
-                smoother.setTargetValue(outGain);
+        void update() noexcept
+        {
+            readTargets();
 
-            isBypassed = params.bypass->get();
+            for (size_t i = 0; i < numSlots; ++i)
+            {
+                if (incoming[i] == target[i])
+                    continue;
+
+                if (stepsToTarget[i] <= 0)
+                {
+                    jump(i, incoming[i]);
+                    continue;
+                }
+
+                target[i] = incoming[i];
+                countdown[i] = stepsToTarget[i];
+                const auto steps = static_cast<float>(stepsToTarget[i]);
+
+                switch (slotSpec(i).type)
+                {
+                    case SmoothingType::linear:
+                        step[i] = (target[i] - current[i]) / steps;
+                        break;
+
+                    // Ramps between the floor when either end is silent, and
+                    // lands exactly on the target when the countdown ends
+                    case SmoothingType::multiplicative:
+                        current[i] = juce::jmax(current[i], multiplicativeFloor);
+                        step[i] = std::exp((std::log(juce::jmax(target[i], multiplicativeFloor)) - std::log(current[i])) / steps);
+                        break;
+
+                    // Distance to the target falls to exponentialResidual over the ramp
+                    case SmoothingType::exponential:
+                        step[i] = std::exp(std::log(exponentialResidual) / steps);
+                        break;
+
+                    default: break;
+                }
+            }
         }
 
+        // Advances every slot by one sample
         void smoothen() noexcept
         {
-            auto smoothen = [](auto& smootherArray)
-            {
-                for (auto& smoother : smootherArray)
-                    smoother.getNextValue();
-            };
-
-            smoothen(inputSmoother);
-            smoothen(tiltSmoother);
-            smoothen(shapeSmoother);
-            smoothen(biasSmoother);
-            smoothen(flutterSmoother);
-            smoothen(speedSmoother);
-            smoothen(bumpHeadSmoother);
-            smoothen(bumpHzSmoother);
-            smoothen(outputSmoother);
+            for (size_t i = 0; i < numSlots; ++i)
+                advance(i, slotSpec(i).type);
         }
 
-
         enum class SmootherUpdateMode
         {
             initialize,
@@ -142,86 +168,189 @@ namespace MarsDSP
         {
             juce::ignoreUnused(init);
 
-            auto skipArray = [numSamplesToSkip](auto& smootherArray)
+            for (size_t i = 0; i < numSlots; ++i)
             {
-                for (auto& s : smootherArray)
-                    s.skip(numSamplesToSkip);
-            };
-
-            skipArray(inputSmoother);
-            skipArray(tiltSmoother);
-            skipArray(shapeSmoother);
-            skipArray(biasSmoother);
-            skipArray(flutterSmoother);
-            skipArray(speedSmoother);
-            skipArray(bumpHeadSmoother);
-            skipArray(bumpHzSmoother);
-            skipArray(outputSmoother);
+                if (countdown[i] <= 0)
+                    continue;
+
+                if (numSamplesToSkip >= countdown[i])
+                {
+                    jump(i, target[i]);
+                    continue;
+                }
+
+                const auto skipped = static_cast<float>(numSamplesToSkip);
+
+                switch (slotSpec(i).type)
+                {
+                    case SmoothingType::linear:         current[i] += step[i] * skipped; break;
+                    case SmoothingType::multiplicative: current[i] *= std::pow(step[i], skipped); break;
+                    case SmoothingType::exponential:    current[i] = target[i] + ((current[i] - target[i]) * std::pow(step[i], skipped)); break;
+                    default: break;
+                }
+
+                countdown[i] -= numSamplesToSkip;
+            }
         }
 
-        // A
-        float getInput(size_t channel = 0) noexcept
-        { return inputSmoother[channel].getNextValue(); }
+        // Next smoothed value of a continuous parameter, e.g. next(Param::tilt)
+        template <size_t Index>
+        float next(ParameterTag<Index>, size_t channel = 0) noexcept
+        {
+            static_assert(ParameterTag<Index>::kind == ParameterKind::continuous, "only continuous parameters are smoothed");
+            return advance(slotOf<Index>(channel), ParameterTag<Index>::spec.smoothing.type);
+        }
 
-        // B
-        float getTilt(size_t channel = 0) noexcept
-        { return tiltSmoother[channel].getNextValue(); }
+        // Writes the next numSamples values of a ramp without advancing it, so a
+        // per-sample consumer can sit alongside the once-per-block next()/skip.
+        // Works on whole groups of samples so the loops vectorise.
+        template <size_t Index>
+        void fillRamp(ParameterTag<Index>, float* destination, int numSamples, size_t channel = 0) const noexcept
+        {
+            static_assert(ParameterTag<Index>::kind == ParameterKind::continuous, "only continuous parameters are smoothed");
+            constexpr auto type = ParameterTag<Index>::spec.smoothing.type;
 
-        // C
-        float getShape(size_t channel = 0) noexcept
-        { return shapeSmoother[channel].getNextValue(); }
+            const size_t i = slotOf<Index>(channel);
+            const float end = target[i];
 
-        // D
-        float getBias(size_t channel = 0) noexcept
-        { return biasSmoother[channel].getNextValue(); }
+            // Samples still on the ramp; the last step of a ramp lands on the target
+            const int rampSamples = juce::jlimit(0, numSamples, countdown[i] - 1);
 
-        // E
-        float getFlutter(size_t channel = 0) noexcept
-        { return flutterSmoother[channel].getNextValue(); }
+            if constexpr (type == SmoothingType::linear)
+            {
+                const float start = current[i], increment = step[i];
 
-        // F
-        float getFlutterSpeed(size_t channel = 0) noexcept
-        { return speedSmoother[channel].getNextValue(); }
+                for (int n = 0; n < rampSamples; ++n)
+                    destination[n] = start + (increment * static_cast<float>(n + 1));
+            }
 
-        // G
-        float getBumpHead(size_t channel = 0) noexcept
-        { return bumpHeadSmoother[channel].getNextValue(); }
+            else
+            {
+                // Powers of the per-sample ratio (or decay) for one group
+                std::array<float, rampGroup> powers {};
+                float power = 1.0f;
+
+                for (auto& p : powers)
+                    p = power *= step[i];
+
+                // Multiplicative ramps scale the value, exponential ones the distance left
+                float base = type == SmoothingType::multiplicative ? current[i] : current[i] - end;
+                const float offset = type == SmoothingType::multiplicative ? 0.0f : end;
+
+                for (int group = 0; group < rampSamples; group += rampGroup)
+                {
+                    float* out = destination + group;
+
+                    if (rampSamples - group >= rampGroup)
+                    {
+                        for (size_t n = 0; n < rampGroup; ++n)
+                            out[n] = offset + (base * powers[n]);
+                    }
+
+                    else
+                    {
+                        for (int n = 0; n < rampSamples - group; ++n)
+                            out[n] = offset + (base * powers[static_cast<size_t>(n)]);
+                    }
+
+                    base *= powers[rampGroup - 1];
+                }
+            }
+
+            std::fill(destination + rampSamples, destination + numSamples, end);
+        }
 
-        // H
-        float getBumpHz(size_t channel = 0) noexcept
-        { return bumpHzSmoother[channel].getNextValue(); }
+        // Latched value of a choice or toggle parameter, e.g. get(Param::bypass)
+        template <size_t Index>
+        typename ParameterTag<Index>::ValueType get(ParameterTag<Index>) const noexcept
+        {
+            static_assert(ParameterTag<Index>::kind != ParameterKind::continuous, "use next() for continuous parameters");
+            return static_cast<typename ParameterTag<Index>::ValueType>(discrete[Index]);
+        }
 
-        // I
-        float getOutput(size_t channel = 0) noexcept
-        { return outputSmoother[channel].getNextValue(); }
+    private:
 
-        bool getBypass() const noexcept { return isBypassed; }
+        static constexpr int rampGroup = 8;
 
-    private:
+        // Lowest level a multiplicative ramp starts from or heads to (-60 dB)
+        static constexpr float multiplicativeFloor = 1.0e-3f;
+
+        // Fraction of the distance left when an exponential ramp snaps to its target
+        static constexpr float exponentialResidual = 1.0e-3f;
+
+        static constexpr size_t numSlots = SmootherLayout::numSlots;
+
+        static constexpr const SmoothingSpec& slotSpec(size_t slot) noexcept
+        {
+            return parameterTable[SmootherLayout::slotParameter[slot]].smoothing;
+        }
+
+        // Linked parameters answer every channel from their single slot
+        template <size_t Index>
+        static constexpr size_t slotOf(size_t channel) noexcept
+        {
+            if constexpr (SmootherLayout::widthOf(parameterTable[Index]) == 1)
+                return SmootherLayout::firstSlot[Index];
+            else
+                return SmootherLayout::firstSlot[Index] + channel;
+        }
+
+        // Reads every parameter once; continuous values land in incoming for
+        // each of their slots, the rest are latched straight away
+        void readTargets() noexcept
+        {
+            forEachParameter([this](auto tag)
+            {
+                using Tag = decltype(tag);
+
+                if constexpr (Tag::kind == ParameterKind::continuous)
+                {
+                    const float value = params.get(tag);
+                    for (size_t channel = 0; channel < SmootherLayout::widthOf(Tag::spec); ++channel)
+                        incoming[SmootherLayout::firstSlot[Tag::index] + channel] = value;
+                }
+
+                else
+                {
+                    discrete[Tag::index] = static_cast<int>(params.get(tag));
+                }
+            });
+        }
+
+        void jump(size_t i, float value) noexcept
+        {
+            current[i] = target[i] = value;
+            countdown[i] = 0;
+        }
+
+        float advance(size_t i, SmoothingType type) noexcept
+        {
+            if (countdown[i] <= 0)
+                return target[i];
+
+            if (--countdown[i] <= 0)
+                return current[i] = target[i];
+
+            switch (type)
+            {
+                case SmoothingType::linear:         current[i] += step[i]; break;
+                case SmoothingType::multiplicative: current[i] *= step[i]; break;
+                case SmoothingType::exponential:    current[i] = target[i] + ((current[i] - target[i]) * step[i]); break;
+                default: break;
+            }
+
+            return current[i];
+        }
 
         const ParametersType& params;
 
-        float input    { 0.0f };
-        float tilt     { 0.0f };
-        float shape    { 0.0f };
-        float bias     { 0.0f };
-        float flutter  { 0.0f };
-        float speed    { 0.0f };
-        float bumpHead { 0.0f };
-        float bumpHz   { 0.0f };
-        float output   { 0.0f };
-
-        bool isBypassed  { false };
-
-        std::array<juce::LinearSmoothedValue<float>, 2>
-        inputSmoother,
-        tiltSmoother,
-        shapeSmoother,
-        biasSmoother,
-        flutterSmoother,
-        speedSmoother,
-        bumpHeadSmoother,
-        bumpHzSmoother,
-        outputSmoother;
+        alignas(64) std::array<float, numSlots> current {};
+        alignas(64) std::array<float, numSlots> target {};
+        alignas(64) std::array<float, numSlots> step {};
+        alignas(64) std::array<float, numSlots> incoming {};
+        alignas(64) std::array<int, numSlots> countdown {};
+        std::array<int, numSlots> stepsToTarget {};
+
+        std::array<int, numParameters> discrete {};
     };
 }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Includes.h>
+
+namespace MarsDSP::UI
+{
+    // One animation clock for every editor in the process, driven by the
+    // display's vertical blank through whichever open editor attached first.
+    // Clients are ticked in turn; each decides for itself whether anything
+    // changed and repaints only that region.
+    //
+    // Paint time reported through ScopedPaintTimer is summed over a short
+    // window. When the average cost per frame goes over paintBudgetMs, clients
+    // are ticked only every second, fourth or eighth frame (staggered so they
+    // do not all land on the same one), and the rate comes back once there is
+    // headroom again. Repaints caused by user interaction are not throttled.
+    class FrameClock
+    {
+    public:
+
+        struct Client
+        {
+            virtual ~Client() = default;
+
+            // Called at most once per vblank, on the message thread
+            virtual void frameTick() = 0;
+
+            // Component the shared vblank can be attached to
+            virtual juce::Component& getFrameComponent() = 0;
+        };
+
+        // Times one paint() and adds it to the shared budget
+        class ScopedPaintTimer
+        {
+        public:
+            explicit ScopedPaintTimer (FrameClock& c) noexcept : clock (c), start (juce::Time::getHighResolutionTicks()) {}
+
+            ~ScopedPaintTimer()
+            {
+                clock.reportPaintTime (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1000.0);
+            }
+
+        private:
+            FrameClock& clock;
+            const juce::int64 start;
+
+            JUCE_DECLARE_NON_COPYABLE (ScopedPaintTimer)
+        };
+
+        FrameClock() = default;
+        ~FrameClock() = default;
+
+        void addClient (Client& client)
+        {
+            clients.push_back (&client);
+
+            if (vblank == nullptr)
+                attachTo (client);
+        }
+
+        void removeClient (Client& client)
+        {
+            clients.erase (std::remove (clients.begin(), clients.end(), &client), clients.end());
+
+            if (attachedClient == &client)
+            {
+                vblank.reset();
+                attachedClient = nullptr;
+
+                if (! clients.empty())
+                    attachTo (*clients.front());
+            }
+        }
+
+        void reportPaintTime (double milliseconds) noexcept
+        {
+            windowPaintMs += milliseconds;
+            lastPaintMs = milliseconds;
+        }
+
+        // 1 when every client animates at the display rate
+        int getFrameDivider() const noexcept { return frameDivider; }
+
+        // Average paint cost per frame over the last full window, all editors together
+        double getAveragePaintMs() const noexcept { return averagePaintMs; }
+        double getLastPaintMs() const noexcept { return lastPaintMs; }
+
+    private:
+
+        static constexpr double paintBudgetMs = 4.0;
+        static constexpr int windowFrames = 30;
+        static constexpr int maxFrameDivider = 8;
+
+        void attachTo (Client& client)
+        {
+            attachedClient = &client;
+            vblank = std::make_unique<juce::VBlankAttachment> (&client.getFrameComponent(), [this] { tick(); });
+        }
+
+        void tick()
+        {
+            ++frame;
+
+            // Index based, as a client may close its editor from inside frameTick
+            for (size_t i = 0; i < clients.size(); ++i)
+                if ((frame + static_cast<juce::uint64> (i)) % static_cast<juce::uint64> (frameDivider) == 0)
+                    clients[i]->frameTick();
+
+            if (++windowFrame < windowFrames)
+                return;
+
+            averagePaintMs = windowPaintMs / windowFrames;
+            windowPaintMs = 0.0;
+            windowFrame = 0;
+
+            // Halve or double the animation rate, with a gap between the two
+            // thresholds so the divider does not flip every window
+            if (averagePaintMs > paintBudgetMs && frameDivider < maxFrameDivider)
+                frameDivider *= 2;
+            else if (averagePaintMs < paintBudgetMs * 0.25 && frameDivider > 1)
+                frameDivider /= 2;
+        }
+
+        std::vector<Client*> clients;
+        Client* attachedClient = nullptr;
+        std::unique_ptr<juce::VBlankAttachment> vblank;
+
+        juce::uint64 frame = 0;
+        int windowFrame = 0;
+        int frameDivider = 1;
+        double windowPaintMs = 0.0, averagePaintMs = 0.0, lastPaintMs = 0.0;
+
+        JUCE_DECLARE_NON_COPYABLE (FrameClock)
+    };
+}
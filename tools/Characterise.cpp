@@ -0,0 +1,408 @@
+// Characterisation of the tape engine across its parameter space, for picking
+// presets and for catching changes in sound between builds.
+//
+// Every point of a grid over tilt, shape, bias, bumpHead and bumpHz is run at
+// several levels and sample rates, each through its own ProcessBlock, spread
+// over all cores. Per point the tool measures
+//
+//   response  gain in dB at the ISO third-octave centres from 20 Hz to 20 kHz,
+//             all at once from a multitone with fixed pseudo-random phases
+//   THD+N     a 1 kHz sine: everything from 20 Hz to 20 kHz but the tone,
+//             relative to the tone
+//   IMD       SMPTE, 60 Hz and 7 kHz at 4:1: the sidebands 7 kHz +- n * 60 Hz
+//             for n = 1..4, relative to the 7 kHz tone
+//
+// Every tone sits on an FFT bin and the engine runs into steady state first,
+// so the captured period needs no window. Flutter and hiss are off, as they
+// would smear or mask what is measured. Input and Output stay at their
+// defaults, so the response includes their -12 and -6 dB. Levels are the peak
+// of the test signal, in dBFS; the multitone has the RMS of the sine at the
+// same level.
+//
+// The multitone's bins are distinct odd primes near each centre, on bins of
+// at most 1.5 Hz: no tone is then a harmonic of another, and the sum or
+// difference of two tones is even, so no second-order product lands on a tone
+// either. Before the grid, a bypassed engine must read flat at every rate,
+// which checks the method itself.
+//
+// The output is one fixed-width row per point, in grid order, with no times
+// or paths in it, so two builds' tables can be compared with diff.
+//
+//   ToBIAS_Characterise [--quick] [--threads N] [--out file]
+//
+//   --quick    48 kHz and -6 dBFS only
+//   --threads  worker threads, default one per core
+//   --out      write the table to a file instead of stdout
+
+#include "ParameterValues.h"
+#include "DSP/ProcessDSP.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+    using namespace MarsDSP::DSP;
+
+    constexpr double maxBinWidth = 1.5;
+    constexpr int blockSize = 512;
+    constexpr double settleSeconds = 0.5;
+
+    constexpr std::array<double, 31> thirdOctaves { 20.0, 25.0, 31.5, 40.0, 50.0, 63.0, 80.0, 100.0, 125.0, 160.0,
+                                                    200.0, 250.0, 315.0, 400.0, 500.0, 630.0, 800.0, 1000.0, 1250.0,
+                                                    1600.0, 2000.0, 2500.0, 3150.0, 4000.0, 5000.0, 6300.0, 8000.0,
+                                                    10000.0, 12500.0, 16000.0, 20000.0 };
+
+    struct Point
+    {
+        double sampleRate = 48000.0;
+        double levelDb = -6.0;
+        float tilt = 0.5f, shape = 0.5f, bias = 0.5f, bumpHead = 0.5f, bumpHz = 75.0f;
+        bool bypass = false;
+    };
+
+    struct Measurement
+    {
+        std::array<double, thirdOctaves.size()> responseDb {};
+        double thdnDb = 0.0;
+        double imdDb = 0.0;
+    };
+
+    std::vector<Point> makeGrid(bool quick)
+    {
+        const std::vector<double> rates = quick ? std::vector<double> { 48000.0 } : std::vector<double> { 44100.0, 48000.0, 96000.0 };
+        const std::vector<double> levels = quick ? std::vector<double> { -6.0 } : std::vector<double> { -18.0, -6.0, 0.0 };
+        constexpr std::array<float, 3> unit { 0.0f, 0.5f, 1.0f };
+        constexpr std::array<float, 3> bumpFrequencies { 40.0f, 75.0f, 120.0f };
+
+        std::vector<Point> grid;
+
+        for (const double rate : rates)
+            for (const double level : levels)
+                for (const float tilt : unit)
+                    for (const float shape : unit)
+                        for (const float bias : unit)
+                            for (const float bumpHead : unit)
+                                for (const float bumpHz : bumpFrequencies)
+                                    grid.push_back({ rate, level, tilt, shape, bias, bumpHead, bumpHz });
+
+        return grid;
+    }
+
+    // Bins no wider than maxBinWidth, fine enough for the lowest third
+    // octaves to each find a prime bin of their own
+    int fftOrderFor(double sampleRate)
+    {
+        int order = 10;
+        while (sampleRate / (1 << order) > maxBinWidth)
+            ++order;
+        return order;
+    }
+
+    bool isOddPrime(int n)
+    {
+        if (n < 3 || n % 2 == 0)
+            return false;
+
+        for (int d = 3; d * d <= n; d += 2)
+            if (n % d == 0)
+                return false;
+
+        return true;
+    }
+
+    // One engine per point; a test signal is one FFT frame of samples,
+    // looped, and the last period after settling is captured
+    class Analyser
+    {
+    public:
+
+        explicit Analyser(const Point& p) : point(p), fftSize(1 << fftOrderFor(p.sampleRate)), fft(fftOrderFor(p.sampleRate))
+        {
+            params.set(MarsDSP::Param::tilt, point.tilt);
+            params.set(MarsDSP::Param::shape, point.shape);
+            params.set(MarsDSP::Param::bias, point.bias);
+            params.set(MarsDSP::Param::bumpHead, point.bumpHead);
+            params.set(MarsDSP::Param::bumpHz, point.bumpHz);
+            params.set(MarsDSP::Param::flutter, 0.0f);
+            params.set(MarsDSP::Param::hiss, 0.0f);
+            params.set(MarsDSP::Param::bypass, point.bypass ? 1.0f : 0.0f);
+
+            processor.prepareDSP(point.sampleRate, blockSize, 2, params);
+        }
+
+        Measurement measure()
+        {
+            const double peak = std::pow(10.0, point.levelDb / 20.0);
+            Measurement m;
+
+            // Response
+            const auto bins = toneBins();
+
+            // N tones of amplitude a have an RMS of a * sqrt(N / 2), the sine's peak / sqrt(2)
+            const double toneAmplitude = peak / std::sqrt(static_cast<double>(bins.size()));
+            uint32_t phaseState = 0x9E3779B9u;
+            std::vector<double> phases;
+
+            for (size_t t = 0; t < bins.size(); ++t)
+            {
+                phaseState = (phaseState * 1664525u) + 1013904223u;
+                phases.push_back(juce::MathConstants<double>::twoPi * (phaseState >> 8) * 0x1.0p-24);
+            }
+
+            const auto multitone = spectrum([&](int i)
+            {
+                double x = 0.0;
+                for (size_t t = 0; t < bins.size(); ++t)
+                    x += std::sin((juce::MathConstants<double>::twoPi * bins[t] * i / fftSize) + phases[t]);
+                return toneAmplitude * x;
+            });
+
+            for (size_t t = 0; t < bins.size(); ++t)
+                m.responseDb[t] = decibels(magnitudeAt(multitone, bins[t]) / toneAmplitude);
+
+            // THD+N
+            const int fundamental = binOf(1000.0);
+            const auto sine = spectrum([&](int i) { return peak * std::sin(juce::MathConstants<double>::twoPi * fundamental * i / fftSize); });
+
+            double residual = 0.0;
+            for (int bin = binOf(20.0); bin <= std::min(binOf(20000.0), (fftSize / 2) - 1); ++bin)
+                if (bin != fundamental)
+                    residual += power(sine, bin);
+
+            m.thdnDb = 10.0 * std::log10(std::max(residual, 1.0e-30) / std::max(power(sine, fundamental), 1.0e-30));
+
+            // SMPTE IMD
+            const int low = binOf(60.0), high = binOf(7000.0);
+            const auto pair = spectrum([&](int i)
+            {
+                const double w = juce::MathConstants<double>::twoPi * i / fftSize;
+                return peak * ((0.8 * std::sin(w * low)) + (0.2 * std::sin(w * high)));
+            });
+
+            double sidebands = 0.0;
+            for (int n = 1; n <= 4; ++n)
+                sidebands += power(pair, high + (n * low)) + power(pair, high - (n * low));
+
+            m.imdDb = 10.0 * std::log10(std::max(sidebands, 1.0e-30) / std::max(power(pair, high), 1.0e-30));
+            return m;
+        }
+
+    private:
+
+        int binOf(double frequency) const
+        {
+            return std::max(1, static_cast<int>(std::lround(frequency * fftSize / point.sampleRate)));
+        }
+
+        // The unused odd prime bin nearest each third-octave centre
+        std::vector<int> toneBins() const
+        {
+            std::vector<int> bins;
+
+            for (const double frequency : thirdOctaves)
+            {
+                const double exact = frequency * fftSize / point.sampleRate;
+                int best = 0;
+
+                for (int offset = 0; best == 0; ++offset)
+                {
+                    for (const int candidate : { static_cast<int>(std::floor(exact)) - offset, static_cast<int>(std::ceil(exact)) + offset })
+                    {
+                        if (! isOddPrime(candidate) || std::find(bins.begin(), bins.end(), candidate) != bins.end())
+                            continue;
+
+                        if (best == 0 || std::abs(candidate - exact) < std::abs(best - exact))
+                            best = candidate;
+                    }
+                }
+
+                bins.push_back(best);
+            }
+
+            return bins;
+        }
+
+        // Runs the looped signal through a freshly reset engine and returns
+        // the magnitude spectrum of the last period, scaled so a full-scale
+        // sine on a bin reads 1
+        template <typename Signal>
+        std::vector<float> spectrum(Signal&& signal)
+        {
+            std::vector<float> period(fftSize);
+            for (int i = 0; i < fftSize; ++i)
+                period[static_cast<size_t>(i)] = static_cast<float>(signal(i));
+
+            processor.reset();
+
+            const int numPeriods = 1 + static_cast<int>(std::ceil(settleSeconds * point.sampleRate / fftSize));
+            const int total = numPeriods * fftSize;
+
+            juce::AudioBuffer<float> buffer(2, blockSize);
+            std::vector<float> data(2 * fftSize, 0.0f);
+
+            for (int start = 0; start < total; start += blockSize)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float x = period[static_cast<size_t>((start + i) % fftSize)];
+                    buffer.setSample(0, i, x);
+                    buffer.setSample(1, i, x);
+                }
+
+                processor.process(buffer);
+
+                if (start >= total - fftSize)
+                    std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + blockSize,
+                              data.begin() + (start - (total - fftSize)));
+            }
+
+            fft.performFrequencyOnlyForwardTransform(data.data());
+
+            for (auto& value : data)
+                value *= 2.0f / fftSize;
+
+            return data;
+        }
+
+        static double magnitudeAt(const std::vector<float>& spectrum, int bin)
+        {
+            return static_cast<double>(spectrum[static_cast<size_t>(bin)]);
+        }
+
+        static double power(const std::vector<float>& spectrum, int bin)
+        {
+            const double magnitude = magnitudeAt(spectrum, bin);
+            return magnitude * magnitude;
+        }
+
+        static double decibels(double gain) { return 20.0 * std::log10(std::max(gain, 1.0e-15)); }
+
+        Point point;
+        int fftSize;
+        MarsDSP::ParameterValues params;
+        ProcessBlock<MarsDSP::ParameterValues> processor;
+        juce::dsp::FFT fft;
+    };
+
+    // To 0.01 dB, so rounding noise between builds does not show as a diff,
+    // and without negative zeros
+    double rounded(double db) { return (std::round(db * 100.0) / 100.0) + 0.0; }
+
+    void writeTable(std::FILE* out, const std::vector<Point>& grid, const std::vector<Measurement>& results)
+    {
+        std::fprintf(out, "# ToBIAS characterisation v2: response in dB at prime bins near the third-octave centres, THD+N and SMPTE IMD in dB\n");
+        std::fprintf(out, "#  rate  level  tilt shape  bias  bump bumpHz    THD+N      IMD");
+
+        for (const double frequency : thirdOctaves)
+        {
+            if (frequency >= 1000.0)
+                std::fprintf(out, " %6.3gk", frequency / 1000.0);
+            else
+                std::fprintf(out, " %7g", frequency);
+        }
+
+        std::fprintf(out, "\n");
+
+        for (size_t p = 0; p < grid.size(); ++p)
+        {
+            const auto& point = grid[p];
+            const auto& m = results[p];
+
+            std::fprintf(out, "%7.0f %6.1f %5.2f %5.2f %5.2f %5.2f %6.1f %8.2f %8.2f", point.sampleRate, point.levelDb,
+                         point.tilt, point.shape, point.bias, point.bumpHead, point.bumpHz, rounded(m.thdnDb), rounded(m.imdDb));
+
+            for (const double gain : m.responseDb)
+                std::fprintf(out, " %7.2f", rounded(gain));
+
+            std::fprintf(out, "\n");
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool quick = false;
+    int numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const char* outPath = nullptr;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        const std::string_view arg(argv[a]);
+
+        if (arg == "--quick")
+            quick = true;
+        else if (arg == "--threads" && a + 1 < argc)
+            numThreads = std::max(1, std::atoi(argv[++a]));
+        else if (arg == "--out" && a + 1 < argc)
+            outPath = argv[++a];
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--quick] [--threads N] [--out file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const auto grid = makeGrid(quick);
+
+    // A bypassed engine must read 0 dB in every band, or the multitone
+    // method is broken and the table would be meaningless
+    for (const double rate : { 44100.0, 48000.0, 96000.0 })
+    {
+        Point bypassed;
+        bypassed.sampleRate = rate;
+        bypassed.bypass = true;
+
+        const auto check = Analyser(bypassed).measure();
+
+        for (size_t t = 0; t < thirdOctaves.size(); ++t)
+        {
+            if (std::abs(check.responseDb[t]) > 0.01)
+            {
+                std::fprintf(stderr, "bypass reads %.3f dB at %g Hz and %g Hz\n", check.responseDb[t], thirdOctaves[t], rate);
+                return 1;
+            }
+        }
+    }
+    std::vector<Measurement> results(grid.size());
+    std::atomic<size_t> next { 0 };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Points are independent, so each thread just takes the next one
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&]
+        {
+            for (size_t p = next.fetch_add(1); p < grid.size(); p = next.fetch_add(1))
+                results[p] = Analyser(grid[p]).measure();
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%zu points on %d threads in %.1f s\n", grid.size(), numThreads, seconds);
+
+    std::FILE* out = outPath != nullptr ? std::fopen(outPath, "w") : stdout;
+
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+
+    writeTable(out, grid, results);
+
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}